@@ -8,6 +8,7 @@
 #include "Device.hpp"
 #include "MemoryPropertyFlags.hpp"
 #include "CommandBuffer.hpp"
+#include "PipelineBarriers.hpp"
 
 namespace QmVk {
 
@@ -96,7 +97,8 @@ shared_ptr<Buffer> Buffer::createFromDeviceMemory(
     vk::BufferUsageFlags usage,
     vk::DeviceMemory deviceMemory,
     vk::MemoryPropertyFlags memoryPropertyFlags,
-    vk::UniqueBuffer *bufferIn)
+    vk::UniqueBuffer *bufferIn,
+    vk::DeviceSize memoryOffset)
 {
     auto buffer = make_shared<Buffer>(
         device,
@@ -105,6 +107,7 @@ shared_ptr<Buffer> Buffer::createFromDeviceMemory(
     );
     buffer->m_memoryPropertyFlags = memoryPropertyFlags;
     buffer->m_deviceMemory.push_back(deviceMemory);
+    buffer->m_memoryOffset = memoryOffset;
     buffer->m_dontFreeMemory = true;
     if (bufferIn)
         buffer->m_buffer = move(*bufferIn);
@@ -136,7 +139,11 @@ void Buffer::init(const MemoryPropertyFlags *userMemoryPropertyFlags)
         vk::BufferCreateInfo bufferCreateInfo;
         bufferCreateInfo.size = m_size;
         bufferCreateInfo.usage = m_usage;
-        if (enabledQueues.size() > 1)
+        if (enabledQueues.size() > 1 && m_device->isExclusiveSharing())
+        {
+            m_exclusiveSharing = true;
+        }
+        else if (enabledQueues.size() > 1)
         {
             bufferCreateInfo.sharingMode = vk::SharingMode::eConcurrent;
             bufferCreateInfo.queueFamilyIndexCount = enabledQueues.size();
@@ -146,11 +153,53 @@ void Buffer::init(const MemoryPropertyFlags *userMemoryPropertyFlags)
         m_buffer = m_device->createBufferUnique(bufferCreateInfo, nullptr, dld());
     }
 
-    m_memoryRequirements = m_device->getBufferMemoryRequirements(*this, dld());
     if (userMemoryPropertyFlags && m_deviceMemory.empty())
-        allocateMemory(*userMemoryPropertyFlags);
+    {
+        vk::MemoryDedicatedAllocateInfo memoryDedicatedAllocateInfo;
+        bool dedicatedAllocation = false;
+
+        if (m_device->hasDedicatedAllocation())
+        {
+            vk::BufferMemoryRequirementsInfo2 bufferMemoryRequirementsInfo2;
+            bufferMemoryRequirementsInfo2.buffer = *m_buffer;
+
+            vk::MemoryRequirements2 memoryRequirements2;
+            vk::MemoryDedicatedRequirements memoryDedicatedRequirements;
+            tie(memoryRequirements2, memoryDedicatedRequirements) = m_device->getBufferMemoryRequirements2<
+                vk::MemoryRequirements2,
+                vk::MemoryDedicatedRequirements
+            >(bufferMemoryRequirementsInfo2, dld()).get<
+                vk::MemoryRequirements2,
+                vk::MemoryDedicatedRequirements
+            >();
+
+            m_memoryRequirements = memoryRequirements2.memoryRequirements;
+            dedicatedAllocation =
+                   memoryDedicatedRequirements.requiresDedicatedAllocation
+                || memoryDedicatedRequirements.prefersDedicatedAllocation
+            ;
+        }
+        else
+        {
+            m_memoryRequirements = m_device->getBufferMemoryRequirements(*this, dld());
+        }
+
+        if (dedicatedAllocation)
+        {
+            memoryDedicatedAllocateInfo.buffer = *m_buffer;
+            allocateMemory(*userMemoryPropertyFlags, &memoryDedicatedAllocateInfo);
+        }
+        else
+        {
+            allocateMemory(*userMemoryPropertyFlags);
+        }
+    }
+    else
+    {
+        m_memoryRequirements = m_device->getBufferMemoryRequirements(*this, dld());
+    }
 
-    m_device->bindBufferMemory(*this, deviceMemory(), 0, dld());
+    m_device->bindBufferMemory(*this, deviceMemory(), m_memoryOffset, dld());
 }
 
 void Buffer::copyTo(
@@ -172,16 +221,18 @@ void Buffer::copyTo(
     }
 
     auto copyCommands = [&](vk::CommandBuffer commandBuffer) {
+        PipelineBarriers pipelineBarriers(m_device, vk::PipelineStageFlagBits2::eCopy);
         pipelineBarrier(
-            commandBuffer,
+            pipelineBarriers,
             vk::PipelineStageFlagBits::eTransfer,
             vk::AccessFlagBits::eTransferRead
         );
         dstBuffer->pipelineBarrier(
-            commandBuffer,
+            pipelineBarriers,
             vk::PipelineStageFlagBits::eTransfer,
             vk::AccessFlagBits::eTransferWrite
         );
+        pipelineBarriers.record(commandBuffer);
 
         if (bufferCopyIn)
         {
@@ -230,11 +281,13 @@ void Buffer::fill(
         throw vk::LogicError("Buffer overflow");
 
     auto fillCommands = [&](vk::CommandBuffer commandBuffer) {
+        PipelineBarriers pipelineBarriers(m_device, vk::PipelineStageFlagBits2::eClear);
         pipelineBarrier(
-            commandBuffer,
+            pipelineBarriers,
             vk::PipelineStageFlagBits::eTransfer,
             vk::AccessFlagBits::eTransferWrite
         );
+        pipelineBarriers.record(commandBuffer);
         commandBuffer.fillBuffer(*m_buffer, offset, size, value, dld());
     };
 
@@ -252,7 +305,7 @@ void Buffer::fill(
 void *Buffer::map()
 {
     if (!m_mapped)
-        m_mapped = m_device->mapMemory(deviceMemory(), 0, memorySize(), {}, dld());
+        m_mapped = mapDeviceMemory();
 
     return m_mapped;
 }
@@ -261,16 +314,78 @@ void Buffer::unmap()
     if (!m_mapped)
         return;
 
-    m_device->unmapMemory(deviceMemory(), dld());
+    unmapDeviceMemory();
     m_mapped = nullptr;
 }
 
+void Buffer::releaseOwnership(
+    vk::CommandBuffer commandBuffer,
+    uint32_t srcQueueFamilyIndex,
+    uint32_t dstQueueFamilyIndex)
+{
+    if (!m_exclusiveSharing || srcQueueFamilyIndex == dstQueueFamilyIndex)
+        return;
+
+    PipelineBarriers pipelineBarriers(m_device);
+    pipelineBarriers.addBufferBarrier(
+        m_stage,
+        vk::PipelineStageFlagBits::eBottomOfPipe,
+        vk::BufferMemoryBarrier(
+            m_accessFlags,
+            vk::AccessFlags(),
+            srcQueueFamilyIndex,
+            dstQueueFamilyIndex,
+            *m_buffer,
+            0,
+            size()
+        )
+    );
+    pipelineBarriers.record(commandBuffer);
+
+    m_ownershipTransfer = {srcQueueFamilyIndex, dstQueueFamilyIndex};
+    m_stage = vk::PipelineStageFlagBits::eTopOfPipe;
+    m_accessFlags = vk::AccessFlags();
+}
+void Buffer::acquireOwnership(vk::CommandBuffer commandBuffer)
+{
+    PipelineBarriers pipelineBarriers(m_device);
+    acquireOwnership(pipelineBarriers.ownershipBarriers());
+    pipelineBarriers.record(commandBuffer);
+}
+void Buffer::acquireOwnership(PipelineBarriers &pipelineBarriers)
+{
+    if (!hasPendingOwnershipTransfer())
+        return;
+
+    // Make the memory visible to everything, next barriers need only an execution dependency
+    pipelineBarriers.addBufferBarrier(
+        vk::PipelineStageFlagBits::eTopOfPipe,
+        vk::PipelineStageFlagBits::eAllCommands,
+        vk::BufferMemoryBarrier(
+            vk::AccessFlags(),
+            vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+            m_ownershipTransfer.first,
+            m_ownershipTransfer.second,
+            *m_buffer,
+            0,
+            size()
+        )
+    );
+
+    m_ownershipTransfer = {VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED};
+    m_stage = vk::PipelineStageFlagBits::eAllCommands;
+    m_accessFlags = vk::AccessFlags();
+}
+
 inline bool Buffer::mustExecPipelineBarrier(
     vk::PipelineStageFlags dstStage,
-    vk::AccessFlags dstAccessFlags)
+    vk::AccessFlags dstAccessFlags,
+    vk::PipelineStageFlags2 transferStage)
 {
     if (m_stage != dstStage || m_accessFlags != dstAccessFlags)
         return true;
+    if ((dstStage & vk::PipelineStageFlagBits::eTransfer) && (m_transferStage & transferStage) != transferStage)
+        return true;
     if ((m_accessFlags & vk::AccessFlagBits::eShaderRead) && (m_accessFlags & vk::AccessFlagBits::eShaderWrite))
         return true;
     return false;
@@ -281,32 +396,36 @@ void Buffer::pipelineBarrier(
     vk::PipelineStageFlags dstStage,
     vk::AccessFlags dstAccessFlags)
 {
-    if (!mustExecPipelineBarrier(dstStage, dstAccessFlags))
+    PipelineBarriers pipelineBarriers(m_device);
+    pipelineBarrier(pipelineBarriers, dstStage, dstAccessFlags);
+    pipelineBarriers.record(commandBuffer);
+}
+void Buffer::pipelineBarrier(
+    PipelineBarriers &pipelineBarriers,
+    vk::PipelineStageFlags dstStage,
+    vk::AccessFlags dstAccessFlags)
+{
+    acquireOwnership(pipelineBarriers.ownershipBarriers());
+
+    if (!mustExecPipelineBarrier(dstStage, dstAccessFlags, pipelineBarriers.transferStage()))
         return;
 
-    vk::BufferMemoryBarrier barrier(
-        m_accessFlags,
-        dstAccessFlags,
-        VK_QUEUE_FAMILY_IGNORED,
-        VK_QUEUE_FAMILY_IGNORED,
-        *m_buffer,
-        0,
-        size()
-    );
-    commandBuffer.pipelineBarrier(
+    pipelineBarriers.addBufferBarrier(
         m_stage,
         dstStage,
-        vk::DependencyFlags(),
-        0,
-        nullptr,
-        1,
-        &barrier,
-        0,
-        nullptr,
-        dld()
+        vk::BufferMemoryBarrier(
+            m_accessFlags,
+            dstAccessFlags,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            *m_buffer,
+            0,
+            size()
+        )
     );
 
     m_stage = dstStage;
+    m_transferStage = pipelineBarriers.transferStage();
     m_accessFlags = dstAccessFlags;
 }
 
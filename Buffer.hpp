@@ -14,11 +14,16 @@ namespace QmVk {
 
 using namespace std;
 
+class PipelineBarriers;
+
 class QMVK_EXPORT Buffer : public MemoryObject, public enable_shared_from_this<Buffer>
 {
     Buffer(const Buffer &) = delete;
 
     friend class MemoryObjectDescr;
+#ifndef QMVK_NO_GRAPHICS
+    friend class Image;
+#endif
 
 public:
     static shared_ptr<Buffer> create(
@@ -50,7 +55,8 @@ public:
         vk::BufferUsageFlags usage,
         vk::DeviceMemory deviceMemory,
         vk::MemoryPropertyFlags memoryPropertyFlags,
-        vk::UniqueBuffer *bufferIn = nullptr
+        vk::UniqueBuffer *bufferIn = nullptr,
+        vk::DeviceSize memoryOffset = 0
     );
 
 public:
@@ -89,13 +95,23 @@ public:
     inline vk::PipelineStageFlags stage() const;
     inline vk::AccessFlags accessFlags() const;
 
+    void releaseOwnership(
+        vk::CommandBuffer commandBuffer,
+        uint32_t srcQueueFamilyIndex,
+        uint32_t dstQueueFamilyIndex
+    ) override;
+    void acquireOwnership(vk::CommandBuffer commandBuffer) override;
+
 public:
     inline operator vk::Buffer() const;
 
 private:
+    void acquireOwnership(PipelineBarriers &pipelineBarriers);
+
     inline bool mustExecPipelineBarrier(
         vk::PipelineStageFlags dstStage,
-        vk::AccessFlags dstAccessFlags
+        vk::AccessFlags dstAccessFlags,
+        vk::PipelineStageFlags2 transferStage
     );
 
     void pipelineBarrier(
@@ -103,6 +119,11 @@ private:
         vk::PipelineStageFlags dstStage,
         vk::AccessFlags dstAccessFlags
     );
+    void pipelineBarrier(
+        PipelineBarriers &pipelineBarriers,
+        vk::PipelineStageFlags dstStage,
+        vk::AccessFlags dstAccessFlags
+    );
 
 private:
     const vk::DeviceSize m_size;
@@ -115,6 +136,7 @@ private:
     bool m_dontFreeMemory = false;
 
     vk::PipelineStageFlags m_stage = vk::PipelineStageFlagBits::eTopOfPipe;
+    vk::PipelineStageFlags2 m_transferStage = vk::PipelineStageFlagBits2::eAllTransfer; // Transfer stages waited for by the last barrier
     vk::AccessFlags m_accessFlags;
 };
 
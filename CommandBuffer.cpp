@@ -10,48 +10,88 @@
 #include "DescriptorSet.hpp"
 #include "MemoryObjectDescrs.hpp"
 
-#include <unordered_set>
+#include <algorithm>
+#include <atomic>
 
 namespace QmVk {
 
+static atomic<uint64_t> g_storedDataEpoch {0};
+
+// Flat lists which keep their capacity between submissions. Memory objects are deduplicated
+// by the epoch stamp, other objects only when stored again immediately. Duplicates can remain
+// (e.g. when the object is stored by many command buffers at once), but they're harmless.
 struct CommandBuffer::StoredData
 {
-    unordered_set<shared_ptr<DescriptorSet>> descriptorSets;
-    unordered_set<shared_ptr<MemoryObjectBase>> memoryObjectsBase;
+    template<typename T>
+    static inline void append(vector<shared_ptr<T>> &objects, const shared_ptr<T> &object)
+    {
+        if (objects.empty() || objects.back() != object)
+            objects.push_back(object);
+    }
+
+    inline void append(const shared_ptr<MemoryObjectBase> &memoryObjectBase)
+    {
+        if (memoryObjectBase->m_storedDataEpoch.exchange(epoch, memory_order_relaxed) != epoch)
+            memoryObjectsBase.push_back(memoryObjectBase);
+    }
+
+    inline void clear()
+    {
+        descriptorSets.clear();
+        memoryObjectsBase.clear();
+        timelineSemaphores.clear();
+        secondaryCommandBuffers.clear();
+        epoch = ++g_storedDataEpoch;
+    }
+
+    uint64_t epoch = ++g_storedDataEpoch;
+    vector<shared_ptr<DescriptorSet>> descriptorSets;
+    vector<shared_ptr<MemoryObjectBase>> memoryObjectsBase;
+    vector<shared_ptr<TimelineSemaphore>> timelineSemaphores;
+    vector<shared_ptr<CommandBuffer>> secondaryCommandBuffers;
 };
 
 shared_ptr<CommandBuffer> CommandBuffer::create(
-    const shared_ptr<Queue> &queue)
+    const shared_ptr<Queue> &queue,
+    vk::CommandBufferLevel level)
 {
     auto commandBuffer = make_shared<CommandBuffer>(
-        queue
+        queue,
+        level
     );
     commandBuffer->init();
     return commandBuffer;
 }
 
 CommandBuffer::CommandBuffer(
-    const shared_ptr<Queue> &queue)
+    const shared_ptr<Queue> &queue,
+    vk::CommandBufferLevel level)
     : m_queue(queue)
     , m_dld(m_queue->dld())
+    , m_level(level)
 {}
 CommandBuffer::~CommandBuffer()
-{}
+{
+    waitForSubmission(m_submission, numeric_limits<uint64_t>::max());
+    finishRecording(m_executed);
+    if (m_commandPoolLock)
+    {
+        if (m_commandPoolLockThread != this_thread::get_id())
+        {
+            // Unfinished recording from another thread, the pool can't be unlocked nor used here
+            m_commandPoolLock.release();
+            return;
+        }
+        m_commandPoolLock.unlock();
+    }
+    if (m_commandPool && *this)
+        m_commandPool->recycle(*this, m_level);
+}
 
 void CommandBuffer::init()
 {
-    const auto device = m_queue->device();
-
-    vk::CommandPoolCreateInfo commandPoolCreateInfo;
-    commandPoolCreateInfo.flags = vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
-    commandPoolCreateInfo.queueFamilyIndex = m_queue->queueFamilyIndex();
-    m_commandPool = device->createCommandPoolUnique(commandPoolCreateInfo, nullptr, dld());
-
-    vk::CommandBufferAllocateInfo commandBufferAllocateInfo;
-    commandBufferAllocateInfo.commandPool = *m_commandPool;
-    commandBufferAllocateInfo.level = vk::CommandBufferLevel::ePrimary;
-    commandBufferAllocateInfo.commandBufferCount = 1;
-    static_cast<vk::CommandBuffer &>(*this) = device->allocateCommandBuffers(commandBufferAllocateInfo, dld())[0];
+    m_commandPool = m_queue->device()->commandPoolManager()->threadPool(m_queue->queueFamilyIndex());
+    static_cast<vk::CommandBuffer &>(*this) = m_commandPool->allocate(m_level);
 }
 
 void CommandBuffer::storeData(
@@ -61,9 +101,10 @@ void CommandBuffer::storeData(
     if (!m_storedData)
         m_storedData = make_unique<StoredData>();
 
-    m_storedData->descriptorSets.insert(descriptorSet);
+    if (descriptorSet)
+        StoredData::append(m_storedData->descriptorSets, descriptorSet);
     memoryObjects.iterateMemoryObjects([this](const shared_ptr<MemoryObjectBase> &object) {
-        m_storedData->memoryObjectsBase.insert(object);
+        m_storedData->append(object);
     });
 }
 void CommandBuffer::storeData(
@@ -72,23 +113,28 @@ void CommandBuffer::storeData(
     if (!m_storedData)
         m_storedData = make_unique<StoredData>();
 
-    m_storedData->memoryObjectsBase.insert(memoryObjectBase);
+    m_storedData->append(memoryObjectBase);
 }
 void CommandBuffer::resetStoredData()
 {
     if (!m_storedData)
         return;
 
-    m_storedData->descriptorSets.clear();
-    m_storedData->memoryObjectsBase.clear();
+    m_storedData->clear();
 }
 
 void CommandBuffer::resetAndBegin()
 {
+    if (isSecondary())
+        throw vk::LogicError("Secondary command buffer must use \"resetAndBeginSecondary()\"");
+
+    waitForPending();
+    lockCommandPool();
     if (m_resetNeeded)
     {
         reset(vk::CommandBufferResetFlags(), dld());
         resetStoredData();
+        finishRecording(false); // Not submitted
     }
     begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit), dld());
     m_resetNeeded = true;
@@ -105,7 +151,7 @@ void CommandBuffer::endSubmitAndWait(
 {
     unique_lock<mutex> queueLock;
 
-    end(dld());
+    endRecording();
 
     if (lock)
         queueLock = m_queue->lock();
@@ -114,19 +160,358 @@ void CommandBuffer::endSubmitAndWait(
     submitInfo.pCommandBuffers = &*this;
     m_queue->submitCommandBuffer(move(submitInfo));
 
+    {
+        // Blocking submissions are never pending, but they still get a number, so the
+        // secondaries executed here don't wait for the next submission of this buffer
+        lock_guard<mutex> locker(m_submissionMutex);
+        ++m_submission;
+    }
+
     if (callback)
         callback();
 
     m_queue->waitForCommandsFinished();
 
+    finishRecording(true);
     resetStoredData();
 }
 
 void CommandBuffer::execute(const CommandCallback &callback)
 {
     resetAndBegin();
-    callback(*this);
+    try
+    {
+        callback(*this);
+    }
+    catch (...)
+    {
+        abortRecording();
+        throw;
+    }
     endSubmitAndWait();
 }
 
+Completion CommandBuffer::endSubmit(
+    vk::SubmitInfo &&submitInfo,
+    bool lock)
+{
+    const auto device = m_queue->device();
+
+    endRecording();
+
+    unique_lock<mutex> locker(m_submissionMutex);
+
+    if (m_pending)
+        throw vk::LogicError("Command buffer is already submitted");
+
+    if (!m_fence)
+    {
+        m_fence = device->createFenceUnique(vk::FenceCreateInfo(), nullptr, dld());
+    }
+    else if (m_fenceResetNeeded)
+    {
+        device->resetFences(*m_fence, dld());
+        m_fenceResetNeeded = false;
+    }
+
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &*this;
+    {
+        unique_lock<mutex> queueLock;
+        if (lock)
+            queueLock = m_queue->lock();
+        m_queue->submitCommandBuffer(move(submitInfo), *m_fence);
+    }
+
+    m_fenceResetNeeded = true;
+    m_pending = true;
+
+    return Completion(shared_from_this(), ++m_submission);
+}
+Completion CommandBuffer::endSubmit(
+    const vector<TimelineSemaphore::Point> &waitPoints,
+    const vector<TimelineSemaphore::Point> &signalPoints,
+    vk::SubmitInfo &&submitInfo,
+    bool lock)
+{
+    if (!m_storedData)
+        m_storedData = make_unique<StoredData>();
+
+    // Binary semaphores from "submitInfo" have their values ignored
+    vector<vk::Semaphore> waitSemaphores(submitInfo.pWaitSemaphores, submitInfo.pWaitSemaphores + submitInfo.waitSemaphoreCount);
+    vector<vk::PipelineStageFlags> waitStages(submitInfo.pWaitDstStageMask, submitInfo.pWaitDstStageMask + submitInfo.waitSemaphoreCount);
+    vector<uint64_t> waitValues(submitInfo.waitSemaphoreCount);
+    for (auto &&waitPoint : waitPoints)
+    {
+        waitSemaphores.push_back(*waitPoint.semaphore);
+        waitStages.push_back(waitPoint.stage);
+        waitValues.push_back(waitPoint.value);
+        StoredData::append(m_storedData->timelineSemaphores, waitPoint.semaphore);
+    }
+
+    vector<vk::Semaphore> signalSemaphores(submitInfo.pSignalSemaphores, submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount);
+    vector<uint64_t> signalValues(submitInfo.signalSemaphoreCount);
+    for (auto &&signalPoint : signalPoints)
+    {
+        signalSemaphores.push_back(*signalPoint.semaphore);
+        signalValues.push_back(signalPoint.value);
+        StoredData::append(m_storedData->timelineSemaphores, signalPoint.semaphore);
+    }
+
+    vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo;
+    timelineSubmitInfo.pNext = submitInfo.pNext;
+    timelineSubmitInfo.waitSemaphoreValueCount = waitValues.size();
+    timelineSubmitInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineSubmitInfo.signalSemaphoreValueCount = signalValues.size();
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues.data();
+
+    submitInfo.pNext = &timelineSubmitInfo;
+    submitInfo.waitSemaphoreCount = waitSemaphores.size();
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.signalSemaphoreCount = signalSemaphores.size();
+    submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+    return endSubmit(move(submitInfo), lock);
+}
+Completion CommandBuffer::executeAsync(const CommandCallback &callback)
+{
+    resetAndBegin();
+    try
+    {
+        callback(*this);
+    }
+    catch (...)
+    {
+        abortRecording();
+        throw;
+    }
+    return endSubmit();
+}
+
+void CommandBuffer::abortRecording()
+{
+    unlockCommandPool();
+}
+
+void CommandBuffer::resetAndBeginSecondary(
+    const vk::CommandBufferInheritanceInfo &inheritanceInfo,
+    vk::CommandBufferUsageFlags flags)
+{
+    if (!isSecondary())
+        throw vk::LogicError("Primary command buffer must use \"resetAndBegin()\"");
+
+    decltype(m_executingPrimaries) executingPrimaries;
+    {
+        lock_guard<mutex> locker(m_submissionMutex);
+        executingPrimaries = move(m_executingPrimaries);
+        m_executingPrimaries.clear();
+    }
+    for (auto &&executingPrimary : executingPrimaries)
+    {
+        if (auto primary = executingPrimary.first.lock())
+            primary->waitForSubmission(executingPrimary.second);
+    }
+
+    lockCommandPool();
+    if (m_resetNeeded)
+    {
+        reset(vk::CommandBufferResetFlags(), dld());
+        resetStoredData();
+        finishRecording(m_executed.exchange(false));
+    }
+
+    if (inheritanceInfo.renderPass)
+        flags |= vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+
+    vk::CommandBufferBeginInfo commandBufferBeginInfo;
+    commandBufferBeginInfo.flags = flags;
+    commandBufferBeginInfo.pInheritanceInfo = &inheritanceInfo;
+    begin(commandBufferBeginInfo, dld());
+    m_resetNeeded = true;
+}
+void CommandBuffer::endSecondary()
+{
+    endRecording();
+}
+
+void CommandBuffer::executeSecondary(const vector<shared_ptr<CommandBuffer>> &secondaryCommandBuffers)
+{
+    if (isSecondary())
+        throw vk::LogicError("Secondary command buffer can't execute other command buffers");
+    if (secondaryCommandBuffers.empty())
+        return;
+
+    if (!m_storedData)
+        m_storedData = make_unique<StoredData>();
+
+    const auto self = shared_from_this();
+    const uint64_t submission = m_submission + 1; // Submission number of the current recording
+
+    vector<vk::CommandBuffer> commandBuffers;
+    commandBuffers.reserve(secondaryCommandBuffers.size());
+    for (auto &&secondaryCommandBuffer : secondaryCommandBuffers)
+    {
+        if (!secondaryCommandBuffer->isSecondary())
+            throw vk::LogicError("Only secondary command buffers can be executed");
+        commandBuffers.push_back(*secondaryCommandBuffer);
+        StoredData::append(m_storedData->secondaryCommandBuffers, secondaryCommandBuffer);
+
+        lock_guard<mutex> locker(secondaryCommandBuffer->m_submissionMutex);
+        auto &executingPrimaries = secondaryCommandBuffer->m_executingPrimaries;
+        auto it = find_if(executingPrimaries.begin(), executingPrimaries.end(), [&](const pair<weak_ptr<CommandBuffer>, uint64_t> &executingPrimary) {
+            return (executingPrimary.first.lock() == self);
+        });
+        if (it != executingPrimaries.end())
+            it->second = submission;
+        else
+            executingPrimaries.emplace_back(self, submission);
+    }
+
+    executeCommands(commandBuffers.size(), commandBuffers.data(), dld());
+}
+
+void CommandBuffer::addRecordingCallback(const RecordingCallback &callback)
+{
+    m_recordingCallbacks.push_back(callback);
+}
+
+bool CommandBuffer::isPending()
+{
+    return !isSubmissionFinished(m_submission);
+}
+void CommandBuffer::waitForPending()
+{
+    waitForSubmission(m_submission);
+}
+
+void CommandBuffer::lockCommandPool()
+{
+    // Unfinished recording, e.g. after an exception
+    unlockCommandPool();
+
+    m_commandPoolLock = m_commandPool->lock();
+    m_commandPoolLockThread = this_thread::get_id();
+}
+void CommandBuffer::unlockCommandPool()
+{
+    if (!m_commandPoolLock)
+        return;
+
+    if (m_commandPoolLockThread != this_thread::get_id())
+        throw vk::LogicError("Command buffer recording must end on the thread which began it");
+
+    m_commandPoolLock.unlock();
+}
+void CommandBuffer::endRecording()
+{
+    if (m_commandPoolLock && m_commandPoolLockThread != this_thread::get_id())
+        throw vk::LogicError("Command buffer recording must end on the thread which began it");
+
+    try
+    {
+        end(dld());
+    }
+    catch (...)
+    {
+        unlockCommandPool();
+        throw;
+    }
+    unlockCommandPool();
+}
+
+bool CommandBuffer::isSubmissionFinished(uint64_t submission)
+{
+    unique_lock<mutex> locker(m_submissionMutex);
+
+    if (!m_pending || submission != m_submission)
+        return true;
+
+    const auto result = m_queue->device()->getFenceStatus(*m_fence, dld());
+    if (result != vk::Result::eSuccess)
+        return false;
+
+    finishSubmission(locker);
+    return true;
+}
+void CommandBuffer::waitForSubmission(uint64_t submission)
+{
+    const bool finished = waitForSubmission(
+        submission,
+#ifdef QMVK_WAIT_TIMEOUT_MS
+        QMVK_WAIT_TIMEOUT_MS * static_cast<uint64_t>(1e6)
+#else
+        numeric_limits<uint64_t>::max()
+#endif
+    );
+    if (!finished)
+        throw vk::SystemError(vk::make_error_code(vk::Result::eTimeout), "vkWaitForFences");
+}
+bool CommandBuffer::waitForSubmission(uint64_t submission, uint64_t timeout)
+{
+    unique_lock<mutex> locker(m_submissionMutex);
+
+    if (!m_pending || submission != m_submission)
+        return true;
+
+    const auto result = m_queue->device()->waitForFences(
+        *m_fence,
+        true,
+        timeout,
+        dld()
+    );
+    if (result == vk::Result::eTimeout)
+        return false;
+
+    finishSubmission(locker);
+    return true;
+}
+void CommandBuffer::addSubmissionCallback(uint64_t submission, const Callback &callback)
+{
+    unique_lock<mutex> locker(m_submissionMutex);
+
+    if (!m_pending || submission != m_submission)
+    {
+        locker.unlock();
+        callback();
+        return;
+    }
+
+    m_submissionCallbacks.push_back(callback);
+}
+
+void CommandBuffer::finishSubmission(unique_lock<mutex> &locker)
+{
+    m_pending = false;
+
+    auto recordingCallbacks = takeRecordingCallbacks(true);
+    resetStoredData();
+
+    auto callbacks = move(m_submissionCallbacks);
+    m_submissionCallbacks.clear();
+
+    locker.unlock();
+    for (auto &&recordingCallback : recordingCallbacks)
+        recordingCallback(true);
+    for (auto &&callback : callbacks)
+        callback();
+}
+vector<CommandBuffer::RecordingCallback> CommandBuffer::takeRecordingCallbacks(bool executed)
+{
+    if (executed && m_storedData)
+    {
+        for (auto &&secondaryCommandBuffer : m_storedData->secondaryCommandBuffers)
+            secondaryCommandBuffer->m_executed = true;
+    }
+
+    auto recordingCallbacks = move(m_recordingCallbacks);
+    m_recordingCallbacks.clear();
+    return recordingCallbacks;
+}
+void CommandBuffer::finishRecording(bool executed)
+{
+    for (auto &&recordingCallback : takeRecordingCallbacks(executed))
+        recordingCallback(executed);
+}
+
 }
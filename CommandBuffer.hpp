@@ -8,10 +8,17 @@
 
 #include "QmVkExport.hpp"
 
+#include "Completion.hpp"
+#include "TimelineSemaphore.hpp"
+#include "CommandPoolManager.hpp"
+
 #include <vulkan/vulkan.hpp>
 
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace QmVk {
 
@@ -22,22 +29,34 @@ class MemoryObjectBase;
 class DescriptorSet;
 class Queue;
 
-class QMVK_EXPORT CommandBuffer : public vk::CommandBuffer
+// Allocated from the command pool of the creating thread (see "CommandPoolManager").
+// The pool is locked between "resetAndBegin()" and the submission, so recording
+// must begin and end on the same thread, otherwise "vk::LogicError" is thrown.
+// Secondary command buffers can be recorded on many threads at once and executed
+// by a primary command buffer. Memory objects are not prepared nor finalized in
+// secondary command buffers (their layouts and stages are tracked in the recording
+// order), do it in the primary command buffer before and after executing them.
+class QMVK_EXPORT CommandBuffer : public vk::CommandBuffer, public enable_shared_from_this<CommandBuffer>
 {
+    friend class Completion;
+
     struct StoredData;
 
 public:
     using Callback = function<void()>;
     using CommandCallback = function<void(vk::CommandBuffer)>;
+    using RecordingCallback = function<void(bool executed)>;
 
 public:
     static shared_ptr<CommandBuffer> create(
-        const shared_ptr<Queue> &queue
+        const shared_ptr<Queue> &queue,
+        vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary
     );
 
 public:
     CommandBuffer(
-        const shared_ptr<Queue> &queue
+        const shared_ptr<Queue> &queue,
+        vk::CommandBufferLevel level
     );
     ~CommandBuffer();
 
@@ -48,6 +67,9 @@ public:
     inline shared_ptr<Queue> queue() const;
     inline const vk::detail::DispatchLoaderDynamic &dld() const;
 
+    inline vk::CommandBufferLevel level() const;
+    inline bool isSecondary() const;
+
     void storeData(
         const MemoryObjectDescrs &memoryObjects,
         const shared_ptr<DescriptorSet> &descriptorSet
@@ -69,14 +91,80 @@ public:
 
     void execute(const CommandCallback &callback);
 
+    // Non-blocking variants, stored data is retained until the submission is finished
+    Completion endSubmit(
+        vk::SubmitInfo &&submitInfo = vk::SubmitInfo(),
+        bool lock = true
+    );
+    // Waits for and signals timeline semaphore values, they're appended to the semaphores in "submitInfo"
+    Completion endSubmit(
+        const vector<TimelineSemaphore::Point> &waitPoints,
+        const vector<TimelineSemaphore::Point> &signalPoints,
+        vk::SubmitInfo &&submitInfo = vk::SubmitInfo(),
+        bool lock = true
+    );
+    Completion executeAsync(const CommandCallback &callback);
+
+    // Unlocks the command pool after a failed recording, the command buffer must be reset before next use
+    void abortRecording();
+
+    // Secondary command buffers only. Render pass continuation is used when "inheritanceInfo.renderPass"
+    // is set. Without "eOneTimeSubmit" in "flags" the commands can be executed many times. Waits for
+    // submissions of all primary command buffers which execute it.
+    void resetAndBeginSecondary(
+        const vk::CommandBufferInheritanceInfo &inheritanceInfo = vk::CommandBufferInheritanceInfo(),
+        vk::CommandBufferUsageFlags flags = vk::CommandBufferUsageFlags()
+    );
+    void endSecondary();
+
+    // Primary command buffers only, secondary command buffers are retained until the submission is finished
+    void executeSecondary(const vector<shared_ptr<CommandBuffer>> &secondaryCommandBuffers);
+
+    // Called once for the current recording: with "true" when its submission is finished (secondary
+    // command buffers: on reset, if a finished primary command buffer executed it), or with "false"
+    // when the recorded commands are discarded without being executed.
+    void addRecordingCallback(const RecordingCallback &callback);
+
+    bool isPending();
+    void waitForPending();
+
+private:
+    void lockCommandPool();
+    void unlockCommandPool();
+    void endRecording();
+
+    bool isSubmissionFinished(uint64_t submission);
+    void waitForSubmission(uint64_t submission);
+    bool waitForSubmission(uint64_t submission, uint64_t timeout);
+    void addSubmissionCallback(uint64_t submission, const Callback &callback);
+
+    void finishSubmission(unique_lock<mutex> &locker);
+    vector<RecordingCallback> takeRecordingCallbacks(bool executed);
+    void finishRecording(bool executed);
+
 private:
     const shared_ptr<Queue> m_queue;
     const vk::detail::DispatchLoaderDynamic &m_dld;
+    const vk::CommandBufferLevel m_level;
 
-    vk::UniqueCommandPool m_commandPool;
+    shared_ptr<CommandPoolManager::Pool> m_commandPool;
+    unique_lock<recursive_mutex> m_commandPoolLock;
+    thread::id m_commandPoolLockThread;
 
     unique_ptr<StoredData> m_storedData;
     bool m_resetNeeded = false;
+
+    mutex m_submissionMutex;
+    vk::UniqueFence m_fence;
+    bool m_fenceResetNeeded = false;
+    uint64_t m_submission = 0;
+    bool m_pending = false;
+    vector<Callback> m_submissionCallbacks;
+
+    vector<pair<weak_ptr<CommandBuffer>, uint64_t>> m_executingPrimaries; // {primary, submission}
+    atomic_bool m_executed {false};
+
+    vector<RecordingCallback> m_recordingCallbacks;
 };
 
 /* Inline implementation */
@@ -90,4 +178,13 @@ const vk::detail::DispatchLoaderDynamic &CommandBuffer::dld() const
     return m_dld;
 }
 
+vk::CommandBufferLevel CommandBuffer::level() const
+{
+    return m_level;
+}
+bool CommandBuffer::isSecondary() const
+{
+    return (m_level == vk::CommandBufferLevel::eSecondary);
+}
+
 }
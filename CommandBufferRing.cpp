@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "CommandBufferRing.hpp"
+#include "CommandBuffer.hpp"
+
+namespace QmVk {
+
+shared_ptr<CommandBufferRing> CommandBufferRing::create(
+    const shared_ptr<Queue> &queue,
+    uint32_t count)
+{
+    auto commandBufferRing = make_shared<CommandBufferRing>(
+        queue,
+        count
+    );
+    commandBufferRing->init();
+    return commandBufferRing;
+}
+
+CommandBufferRing::CommandBufferRing(
+    const shared_ptr<Queue> &queue,
+    uint32_t count)
+    : m_queue(queue)
+    , m_count(max(count, 1u))
+{}
+CommandBufferRing::~CommandBufferRing()
+{}
+
+void CommandBufferRing::init()
+{
+    m_commandBuffers.reserve(m_count);
+    for (uint32_t i = 0; i < m_count; ++i)
+        m_commandBuffers.push_back(CommandBuffer::create(m_queue));
+    m_currentIndex = m_count - 1;
+}
+
+bool CommandBufferRing::isNextReady() const
+{
+    return !m_commandBuffers[(m_currentIndex + 1) % m_count]->isPending();
+}
+
+shared_ptr<CommandBuffer> CommandBufferRing::beginNext()
+{
+    m_currentIndex = (m_currentIndex + 1) % m_count;
+
+    auto &commandBuffer = m_commandBuffers[m_currentIndex];
+    commandBuffer->resetAndBegin();
+    return commandBuffer;
+}
+
+Completion CommandBufferRing::submit(
+    vk::SubmitInfo &&submitInfo,
+    bool lock)
+{
+    return m_commandBuffers[m_currentIndex]->endSubmit(move(submitInfo), lock);
+}
+
+void CommandBufferRing::waitAll()
+{
+    for (auto &&commandBuffer : m_commandBuffers)
+        commandBuffer->waitForPending();
+}
+
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include "Completion.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace QmVk {
+
+using namespace std;
+
+class CommandBuffer;
+class Queue;
+
+// Ring of command buffers for recording the next frame while the previous
+// ones are still executed. Every slot has its own fence and stored data.
+class QMVK_EXPORT CommandBufferRing
+{
+public:
+    static shared_ptr<CommandBufferRing> create(
+        const shared_ptr<Queue> &queue,
+        uint32_t count = 2
+    );
+
+public:
+    CommandBufferRing(
+        const shared_ptr<Queue> &queue,
+        uint32_t count
+    );
+    ~CommandBufferRing();
+
+private:
+    void init();
+
+public:
+    inline shared_ptr<Queue> queue() const;
+
+    inline uint32_t count() const;
+    inline uint32_t currentIndex() const;
+    inline shared_ptr<CommandBuffer> current() const;
+
+    bool isNextReady() const;
+
+    // Waits until the next slot is finished, then resets it and begins recording
+    shared_ptr<CommandBuffer> beginNext();
+
+    Completion submit(
+        vk::SubmitInfo &&submitInfo = vk::SubmitInfo(),
+        bool lock = true
+    );
+
+    void waitAll();
+
+private:
+    const shared_ptr<Queue> m_queue;
+    const uint32_t m_count;
+
+    vector<shared_ptr<CommandBuffer>> m_commandBuffers;
+    uint32_t m_currentIndex = 0;
+};
+
+/* Inline implementation */
+
+shared_ptr<Queue> CommandBufferRing::queue() const
+{
+    return m_queue;
+}
+
+uint32_t CommandBufferRing::count() const
+{
+    return m_count;
+}
+uint32_t CommandBufferRing::currentIndex() const
+{
+    return m_currentIndex;
+}
+shared_ptr<CommandBuffer> CommandBufferRing::current() const
+{
+    return m_commandBuffers[m_currentIndex];
+}
+
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "CommandPoolManager.hpp"
+#include "Device.hpp"
+
+#include <algorithm>
+
+namespace QmVk {
+
+struct CommandPoolManager::Pools
+{
+    mutex poolsMutex;
+    map<pair<thread::id, uint32_t>, shared_ptr<Pool>> pools;
+};
+
+struct CommandPoolManager::ThreadPools
+{
+    struct Entry
+    {
+        weak_ptr<Pools> pools;
+        weak_ptr<Pool> pool;
+    };
+
+    ~ThreadPools()
+    {
+        const auto threadId = this_thread::get_id();
+        for (auto &&entry : entries)
+        {
+            auto pools = entry.pools.lock();
+            auto pool = entry.pool.lock();
+            if (!pools || !pool)
+                continue;
+
+            lock_guard<mutex> locker(pools->poolsMutex);
+            pools->pools.erase({threadId, pool->queueFamilyIndex()});
+        }
+    }
+
+    vector<Entry> entries;
+};
+
+CommandPoolManager::Pool::Pool(Device &device, uint32_t queueFamilyIndex)
+    : m_device(device)
+    , m_queueFamilyIndex(queueFamilyIndex)
+{
+    vk::CommandPoolCreateInfo commandPoolCreateInfo;
+    commandPoolCreateInfo.flags = vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+    commandPoolCreateInfo.queueFamilyIndex = m_queueFamilyIndex;
+    m_commandPool = m_device.createCommandPoolUnique(commandPoolCreateInfo, nullptr, m_device.dld());
+}
+CommandPoolManager::Pool::~Pool()
+{}
+
+unique_lock<recursive_mutex> CommandPoolManager::Pool::lock()
+{
+    return unique_lock<recursive_mutex>(m_mutex);
+}
+
+vk::CommandBuffer CommandPoolManager::Pool::allocate(vk::CommandBufferLevel level)
+{
+    lock_guard<recursive_mutex> locker(m_mutex);
+
+    auto &freeCommandBuffers = m_freeCommandBuffers[level == vk::CommandBufferLevel::ePrimary ? 0 : 1];
+    if (!freeCommandBuffers.empty())
+    {
+        const auto commandBuffer = freeCommandBuffers.back();
+        freeCommandBuffers.pop_back();
+        return commandBuffer;
+    }
+
+    vk::CommandBufferAllocateInfo commandBufferAllocateInfo;
+    commandBufferAllocateInfo.commandPool = *m_commandPool;
+    commandBufferAllocateInfo.level = level;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+    return m_device.allocateCommandBuffers(commandBufferAllocateInfo, m_device.dld())[0];
+}
+void CommandPoolManager::Pool::recycle(vk::CommandBuffer commandBuffer, vk::CommandBufferLevel level)
+{
+    lock_guard<recursive_mutex> locker(m_mutex);
+
+    commandBuffer.reset(vk::CommandBufferResetFlags(), m_device.dld());
+    m_freeCommandBuffers[level == vk::CommandBufferLevel::ePrimary ? 0 : 1].push_back(commandBuffer);
+}
+
+void CommandPoolManager::Pool::reset()
+{
+    lock_guard<recursive_mutex> locker(m_mutex);
+    m_device.resetCommandPool(*m_commandPool, vk::CommandPoolResetFlags(), m_device.dld());
+}
+
+CommandPoolManager::CommandPoolManager(Device &device)
+    : m_device(device)
+    , m_pools(make_shared<Pools>())
+{}
+CommandPoolManager::~CommandPoolManager()
+{}
+
+shared_ptr<CommandPoolManager::Pool> CommandPoolManager::threadPool(uint32_t queueFamilyIndex)
+{
+    auto &entries = threadPools().entries;
+
+    entries.erase(remove_if(entries.begin(), entries.end(), [](const ThreadPools::Entry &entry) {
+        return entry.pools.expired() || entry.pool.expired();
+    }), entries.end());
+
+    for (auto &&entry : entries)
+    {
+        if (entry.pools.lock() != m_pools)
+            continue;
+
+        auto pool = entry.pool.lock();
+        if (pool && pool->queueFamilyIndex() == queueFamilyIndex)
+            return pool;
+    }
+
+    auto pool = make_shared<Pool>(m_device, queueFamilyIndex);
+    {
+        lock_guard<mutex> locker(m_pools->poolsMutex);
+        m_pools->pools[{this_thread::get_id(), queueFamilyIndex}] = pool;
+    }
+    entries.push_back({m_pools, pool});
+    return pool;
+}
+
+void CommandPoolManager::resetThreadPools()
+{
+    for (auto &&entry : threadPools().entries)
+    {
+        if (entry.pools.lock() != m_pools)
+            continue;
+
+        if (auto pool = entry.pool.lock())
+            pool->reset();
+    }
+}
+
+CommandPoolManager::ThreadPools &CommandPoolManager::threadPools()
+{
+    static thread_local ThreadPools threadPools;
+    return threadPools;
+}
+
+}
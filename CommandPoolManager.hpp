@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <map>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+
+// Keeps one command pool per thread and queue family, so command buffers can be
+// created and recorded on many threads without creating a pool for each of them.
+// Pools of a thread are released when the thread exits.
+class QMVK_EXPORT CommandPoolManager
+{
+    CommandPoolManager(const CommandPoolManager &) = delete;
+
+    struct Pools;
+    struct ThreadPools;
+
+public:
+    // The lock must be held while allocating, recording, resetting or freeing command
+    // buffers from the pool. It's recursive, so the owning thread can record many command
+    // buffers at once. Other threads only wait when they use command buffers created here.
+    class QMVK_EXPORT Pool
+    {
+        Pool(const Pool &) = delete;
+
+    public:
+        Pool(Device &device, uint32_t queueFamilyIndex);
+        ~Pool();
+
+    public:
+        inline uint32_t queueFamilyIndex() const;
+
+        unique_lock<recursive_mutex> lock();
+
+        // Command buffers are reused if possible
+        vk::CommandBuffer allocate(vk::CommandBufferLevel level);
+        void recycle(vk::CommandBuffer commandBuffer, vk::CommandBufferLevel level);
+
+        // Resets all command buffers, none of them can be pending
+        void reset();
+
+    private:
+        Device &m_device;
+        const uint32_t m_queueFamilyIndex;
+
+        recursive_mutex m_mutex;
+        vk::UniqueCommandPool m_commandPool;
+        vector<vk::CommandBuffer> m_freeCommandBuffers[2];
+    };
+
+public:
+    CommandPoolManager(Device &device);
+    ~CommandPoolManager();
+
+public:
+    // Returns the command pool of the calling thread
+    shared_ptr<Pool> threadPool(uint32_t queueFamilyIndex);
+
+    // Resets all command pools of the calling thread at once (e.g. once per frame),
+    // none of their command buffers can be pending
+    void resetThreadPools();
+
+private:
+    static ThreadPools &threadPools();
+
+private:
+    Device &m_device;
+
+    const shared_ptr<Pools> m_pools;
+};
+
+/* Inline implementation */
+
+uint32_t CommandPoolManager::Pool::queueFamilyIndex() const
+{
+    return m_queueFamilyIndex;
+}
+
+}
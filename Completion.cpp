@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "Completion.hpp"
+#include "CommandBuffer.hpp"
+
+namespace QmVk {
+
+Completion::Completion(
+    const shared_ptr<CommandBuffer> &commandBuffer,
+    uint64_t submission)
+    : m_commandBuffer(commandBuffer)
+    , m_submission(submission)
+{}
+
+bool Completion::isFinished() const
+{
+    if (!m_commandBuffer)
+        return true;
+    return m_commandBuffer->isSubmissionFinished(m_submission);
+}
+
+bool Completion::wait(uint64_t timeout) const
+{
+    if (!m_commandBuffer)
+        return true;
+    return m_commandBuffer->waitForSubmission(m_submission, timeout);
+}
+
+void Completion::then(const Callback &callback) const
+{
+    if (!m_commandBuffer)
+    {
+        callback();
+        return;
+    }
+    m_commandBuffer->addSubmissionCallback(m_submission, callback);
+}
+
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <functional>
+#include <limits>
+#include <memory>
+
+namespace QmVk {
+
+using namespace std;
+
+class CommandBuffer;
+
+// Handle of a single command buffer submission. Keeps the command buffer
+// and its stored data alive until the submission is finished.
+class QMVK_EXPORT Completion
+{
+public:
+    using Callback = function<void()>;
+
+public:
+    Completion() = default;
+    Completion(
+        const shared_ptr<CommandBuffer> &commandBuffer,
+        uint64_t submission
+    );
+
+public:
+    inline bool isValid() const;
+    inline shared_ptr<CommandBuffer> commandBuffer() const;
+
+    bool isFinished() const;
+
+    // Timeout is in nanoseconds, returns false on timeout
+    bool wait(uint64_t timeout = numeric_limits<uint64_t>::max()) const;
+
+    // Callback is executed when the submission is known to be finished
+    // (on "isFinished()", "wait()" or when the command buffer is reused).
+    // It's executed immediately if the submission is already finished.
+    void then(const Callback &callback) const;
+
+private:
+    shared_ptr<CommandBuffer> m_commandBuffer;
+    uint64_t m_submission = 0;
+};
+
+/* Inline implementation */
+
+bool Completion::isValid() const
+{
+    return static_cast<bool>(m_commandBuffer);
+}
+shared_ptr<CommandBuffer> Completion::commandBuffer() const
+{
+    return m_commandBuffer;
+}
+
+}
@@ -7,6 +7,8 @@
 #include "ComputePipeline.hpp"
 #include "PhysicalDevice.hpp"
 #include "Device.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineObjectCache.hpp"
 #include "ShaderModule.hpp"
 #include "CommandBuffer.hpp"
 
@@ -62,8 +64,16 @@ void ComputePipeline::createPipeline()
     if (m_dispatchBase)
         pipelineCreateInfo.flags = vk::PipelineCreateFlagBits::eDispatchBase;
     pipelineCreateInfo.stage = m_shaderModule->getPipelineShaderStageCreateInfo(specializationInfo);
-    pipelineCreateInfo.layout = *m_pipelineLayout;
-    m_pipeline = m_device->createComputePipelineUnique(nullptr, pipelineCreateInfo, nullptr, m_dld).value;
+    pipelineCreateInfo.layout = **m_pipelineLayout;
+
+    string key;
+    PipelineObjectCache::appendKey(key, m_shaderModule->id());
+    PipelineObjectCache::appendKey(key, pipelineCreateInfo.flags);
+    PipelineObjectCache::appendKey(key, specializationData);
+
+    setPipeline(move(key), [&] {
+        return m_device->createComputePipelineUnique(*m_device->pipelineCache(), pipelineCreateInfo, nullptr, m_dld).value;
+    });
 }
 
 void ComputePipeline::setCustomSpecializationData(const vector<uint32_t> &data)
@@ -112,7 +122,9 @@ vk::Extent2D ComputePipeline::groupCount(const vk::Extent2D &size) const
 
 void ComputePipeline::recordCommandsInit(const shared_ptr<CommandBuffer> &commandBuffer)
 {
-    prepareObjects(commandBuffer);
+    // Objects state is shared, so secondary command buffers recorded in parallel must not modify it
+    if (!commandBuffer->isSecondary())
+        prepareObjects(commandBuffer);
     bindObjects(commandBuffer, vk::PipelineBindPoint::eCompute);
 }
 void ComputePipeline::recordCommandsCompute(
@@ -155,7 +167,7 @@ void ComputePipeline::recordCommands(
 {
     recordCommandsInit(commandBuffer);
     recordCommandsCompute(commandBuffer, groupCount);
-    if (doFinalizeObjects)
+    if (doFinalizeObjects && !commandBuffer->isSecondary())
         finalizeObjects(commandBuffer, true, false);
 }
 void ComputePipeline::recordCommands(
@@ -166,7 +178,7 @@ void ComputePipeline::recordCommands(
 {
     recordCommandsInit(commandBuffer);
     recordCommandsCompute(commandBuffer, baseGroup, groupCount);
-    if (doFinalizeObjects)
+    if (doFinalizeObjects && !commandBuffer->isSecondary())
         finalizeObjects(commandBuffer, true, false);
 }
 
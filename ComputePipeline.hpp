@@ -46,6 +46,8 @@ public:
     inline vk::Extent2D localWorkGroupSize() const;
     vk::Extent2D groupCount(const vk::Extent2D &size) const;
 
+    // Objects are not prepared nor finalized for secondary command buffers, use "prepareObjects()"
+    // and "finalizeObjects()" with the primary command buffer instead.
     void recordCommandsInit(const shared_ptr<CommandBuffer> &commandBuffer);
     void recordCommandsCompute(
         const shared_ptr<CommandBuffer> &commandBuffer,
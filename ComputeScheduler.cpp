@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "ComputeScheduler.hpp"
+#include "PhysicalDevice.hpp"
+#include "Device.hpp"
+#include "Queue.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace QmVk {
+
+shared_ptr<ComputeScheduler> ComputeScheduler::create(
+    const shared_ptr<Device> &device,
+    Policy policy)
+{
+    auto computeScheduler = make_shared<ComputeScheduler>(
+        device,
+        policy
+    );
+    computeScheduler->init();
+    return computeScheduler;
+}
+
+ComputeScheduler::ComputeScheduler(
+    const shared_ptr<Device> &device,
+    Policy policy)
+    : m_device(device)
+    , m_policy(policy)
+{}
+ComputeScheduler::~ComputeScheduler()
+{
+    waitAll();
+}
+
+void ComputeScheduler::init()
+{
+    const auto physicalDevice = m_device->physicalDevice();
+    for (auto &&queueFamilyIndex : m_device->queues())
+    {
+        if (!(physicalDevice->getQueueProps(queueFamilyIndex).flags & vk::QueueFlagBits::eCompute))
+            continue;
+
+        const uint32_t numQueues = m_device->numQueues(queueFamilyIndex);
+        for (uint32_t i = 0; i < numQueues; ++i)
+        {
+            QueueSlot queueSlot;
+            queueSlot.queue = m_device->queue(queueFamilyIndex, i);
+            m_queueSlots.push_back(move(queueSlot));
+        }
+    }
+    if (m_queueSlots.empty())
+        throw vk::LogicError("No compute queues");
+}
+
+Completion ComputeScheduler::submit(const CommandBuffer::CommandCallback &callback)
+{
+    uint32_t queueSlotIdx = 0;
+    shared_ptr<CommandBuffer> commandBuffer;
+
+    {
+        lock_guard<mutex> locker(m_mutex);
+
+        for (auto &&queueSlot : m_queueSlots)
+            recycleFinished(queueSlot);
+
+        queueSlotIdx = chooseQueueSlot();
+
+        auto &queueSlot = m_queueSlots[queueSlotIdx];
+        if (queueSlot.idle.empty())
+        {
+            commandBuffer = CommandBuffer::create(queueSlot.queue);
+        }
+        else
+        {
+            commandBuffer = move(queueSlot.idle.back());
+            queueSlot.idle.pop_back();
+        }
+        ++queueSlot.recording;
+    }
+
+    Completion completion;
+    try
+    {
+        completion = commandBuffer->executeAsync(callback);
+    }
+    catch (...)
+    {
+        lock_guard<mutex> locker(m_mutex);
+        auto &queueSlot = m_queueSlots[queueSlotIdx];
+        --queueSlot.recording;
+        queueSlot.idle.push_back(move(commandBuffer));
+        throw;
+    }
+
+    lock_guard<mutex> locker(m_mutex);
+    auto &queueSlot = m_queueSlots[queueSlotIdx];
+    --queueSlot.recording;
+    queueSlot.inFlight.push_back(move(commandBuffer));
+    return completion;
+}
+
+void ComputeScheduler::waitAll()
+{
+    lock_guard<mutex> locker(m_mutex);
+    for (auto &&queueSlot : m_queueSlots)
+    {
+        for (auto &&commandBuffer : queueSlot.inFlight)
+            commandBuffer->waitForPending();
+        move(queueSlot.inFlight.begin(), queueSlot.inFlight.end(), back_inserter(queueSlot.idle));
+        queueSlot.inFlight.clear();
+    }
+}
+
+void ComputeScheduler::recycleFinished(QueueSlot &queueSlot)
+{
+    auto finishedIt = partition(queueSlot.inFlight.begin(), queueSlot.inFlight.end(), [](const shared_ptr<CommandBuffer> &commandBuffer) {
+        return commandBuffer->isPending();
+    });
+    move(finishedIt, queueSlot.inFlight.end(), back_inserter(queueSlot.idle));
+    queueSlot.inFlight.erase(finishedIt, queueSlot.inFlight.end());
+}
+
+uint32_t ComputeScheduler::chooseQueueSlot()
+{
+    const uint32_t n = m_queueSlots.size();
+    const uint32_t first = m_nextQueueSlot;
+    m_nextQueueSlot = (m_nextQueueSlot + 1) % n;
+
+    if (m_policy == Policy::RoundRobin)
+        return first;
+
+    // Least loaded, ties are resolved in round-robin order
+    uint32_t bestIdx = first;
+    size_t bestLoad = numeric_limits<size_t>::max();
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const uint32_t idx = (first + i) % n;
+        const auto &queueSlot = m_queueSlots[idx];
+
+        const size_t load = queueSlot.inFlight.size() + queueSlot.recording;
+        if (load < bestLoad)
+        {
+            bestIdx = idx;
+            bestLoad = load;
+            if (load == 0)
+                break;
+        }
+    }
+    return bestIdx;
+}
+
+}
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include "CommandBuffer.hpp"
+
+#include <mutex>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+class Queue;
+
+// Distributes independent workloads across all queues of the enabled compute queue families.
+// Every queue has its own command buffers, the queue itself is locked only while submitting.
+class QMVK_EXPORT ComputeScheduler
+{
+    struct QueueSlot
+    {
+        shared_ptr<Queue> queue;
+        vector<shared_ptr<CommandBuffer>> idle;
+        vector<shared_ptr<CommandBuffer>> inFlight;
+        uint32_t recording = 0;
+    };
+
+public:
+    enum class Policy
+    {
+        RoundRobin,
+        LeastLoaded,
+    };
+
+public:
+    static shared_ptr<ComputeScheduler> create(
+        const shared_ptr<Device> &device,
+        Policy policy = Policy::LeastLoaded
+    );
+
+public:
+    ComputeScheduler(
+        const shared_ptr<Device> &device,
+        Policy policy
+    );
+    ~ComputeScheduler();
+
+private:
+    void init();
+
+public:
+    inline uint32_t queuesCount() const;
+
+    // "callback" records the commands, e.g. "ComputePipeline::recordCommands()".
+    // It can be called from many threads simultaneously.
+    Completion submit(const CommandBuffer::CommandCallback &callback);
+
+    void waitAll();
+
+private:
+    static void recycleFinished(QueueSlot &queueSlot);
+
+    uint32_t chooseQueueSlot();
+
+private:
+    const shared_ptr<Device> m_device;
+    const Policy m_policy;
+
+    mutex m_mutex;
+    vector<QueueSlot> m_queueSlots;
+    uint32_t m_nextQueueSlot = 0;
+};
+
+/* Inline implementation */
+
+uint32_t ComputeScheduler::queuesCount() const
+{
+    return m_queueSlots.size();
+}
+
+}
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "DescriptorAllocator.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "Device.hpp"
+
+namespace QmVk {
+
+static constexpr uint32_t g_minPoolMaxSets = 16;
+static constexpr uint32_t g_maxPoolMaxSets = 256;
+
+struct DescriptorAllocator::Pages
+{
+    // Every set of the pages is allocated with it, recycled sets outlive the user's layout
+    vk::UniqueDescriptorSetLayout descriptorSetLayout;
+    vector<vk::UniqueDescriptorPool> pools;
+    uint32_t nextMaxSets = g_minPoolMaxSets;
+    vector<vk::DescriptorSet> freeDescriptorSets;
+};
+
+DescriptorAllocator::DescriptorAllocator(Device &device)
+    : m_device(device)
+{}
+DescriptorAllocator::~DescriptorAllocator()
+{}
+
+bool DescriptorAllocator::canAllocate(const DescriptorSetLayout &descriptorSetLayout)
+{
+    if (descriptorSetLayout.isPushDescriptor())
+        return false;
+#ifndef QMVK_NO_GRAPHICS
+    for (auto &&descriptorType : descriptorSetLayout.descriptorTypes())
+    {
+        if (!descriptorType.immutableSamplers.empty())
+            return false;
+    }
+#endif
+    return !descriptorSetLayout.isEmpty();
+}
+
+vk::DescriptorSet DescriptorAllocator::allocate(const DescriptorSetLayout &descriptorSetLayout)
+{
+    const auto key = getKey(descriptorSetLayout);
+
+    lock_guard<mutex> locker(m_mutex);
+
+    auto &pages = m_pages[key];
+
+    if (!pages.freeDescriptorSets.empty())
+    {
+        const auto descriptorSet = pages.freeDescriptorSets.back();
+        pages.freeDescriptorSets.pop_back();
+        return descriptorSet;
+    }
+
+    if (!pages.descriptorSetLayout)
+        pages.descriptorSetLayout = descriptorSetLayout.createDescriptorSetLayout();
+
+    vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
+    descriptorSetAllocateInfo.descriptorSetCount = 1;
+    descriptorSetAllocateInfo.pSetLayouts = &*pages.descriptorSetLayout;
+
+    if (!pages.pools.empty())
+    {
+        descriptorSetAllocateInfo.descriptorPool = *pages.pools.back();
+        try
+        {
+            return m_device.allocateDescriptorSets(descriptorSetAllocateInfo, m_device.dld())[0];
+        }
+        catch (const vk::OutOfPoolMemoryError &)
+        {}
+        catch (const vk::FragmentedPoolError &)
+        {}
+    }
+
+    createPool(descriptorSetLayout, pages);
+
+    descriptorSetAllocateInfo.descriptorPool = *pages.pools.back();
+    return m_device.allocateDescriptorSets(descriptorSetAllocateInfo, m_device.dld())[0];
+}
+void DescriptorAllocator::free(const DescriptorSetLayout &descriptorSetLayout, vk::DescriptorSet descriptorSet)
+{
+    const auto key = getKey(descriptorSetLayout);
+
+    lock_guard<mutex> locker(m_mutex);
+    m_pages[key].freeDescriptorSets.push_back(descriptorSet);
+}
+
+string DescriptorAllocator::getKey(const DescriptorSetLayout &descriptorSetLayout)
+{
+    const auto &descriptorTypes = descriptorSetLayout.descriptorTypes();
+
+    string key;
+    key.reserve(descriptorTypes.size() * (sizeof(vk::DescriptorType) + sizeof(uint32_t)));
+    for (auto &&descriptorType : descriptorTypes)
+    {
+        key.append(reinterpret_cast<const char *>(&descriptorType.type), sizeof(vk::DescriptorType));
+        key.append(reinterpret_cast<const char *>(&descriptorType.descriptorCount), sizeof(uint32_t));
+    }
+    return key;
+}
+
+void DescriptorAllocator::createPool(const DescriptorSetLayout &descriptorSetLayout, Pages &pages)
+{
+    const auto &descriptorTypes = descriptorSetLayout.descriptorTypes();
+    const auto maxSets = pages.nextMaxSets;
+
+    vector<vk::DescriptorPoolSize> descriptorPoolSizes(
+        descriptorTypes.begin(),
+        descriptorTypes.end()
+    );
+    for (auto &&descriptorPoolSize : descriptorPoolSizes)
+        descriptorPoolSize.descriptorCount *= maxSets;
+
+    // Descriptor sets are never freed back to the pool, they are recycled instead
+    vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
+    descriptorPoolCreateInfo.maxSets = maxSets;
+    descriptorPoolCreateInfo.poolSizeCount = descriptorPoolSizes.size();
+    descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
+    pages.pools.push_back(m_device.createDescriptorPoolUnique(descriptorPoolCreateInfo, nullptr, m_device.dld()));
+
+    pages.nextMaxSets = min(maxSets * 2, g_maxPoolMaxSets);
+}
+
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <unordered_map>
+#include <mutex>
+
+namespace QmVk {
+
+using namespace std;
+
+class DescriptorSetLayout;
+class Device;
+
+// Allocates descriptor sets from shared pools. Pools are grouped by descriptor
+// types, grow on demand and freed sets are recycled for the same descriptor types.
+class QMVK_EXPORT DescriptorAllocator
+{
+    DescriptorAllocator(const DescriptorAllocator &) = delete;
+
+    struct Pages;
+
+public:
+    DescriptorAllocator(Device &device);
+    ~DescriptorAllocator();
+
+public:
+    // Descriptor sets with immutable samplers must have their own pool
+    static bool canAllocate(const DescriptorSetLayout &descriptorSetLayout);
+
+    vk::DescriptorSet allocate(const DescriptorSetLayout &descriptorSetLayout);
+    void free(const DescriptorSetLayout &descriptorSetLayout, vk::DescriptorSet descriptorSet);
+
+private:
+    static string getKey(const DescriptorSetLayout &descriptorSetLayout);
+
+    void createPool(const DescriptorSetLayout &descriptorSetLayout, Pages &pages);
+
+private:
+    Device &m_device;
+
+    mutex m_mutex;
+    unordered_map<string, Pages> m_pages;
+};
+
+}
@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "DescriptorHeap.hpp"
+#include "Device.hpp"
+#include "Buffer.hpp"
+#ifndef QMVK_NO_GRAPHICS
+#   include "Sampler.hpp"
+#   include "Image.hpp"
+#endif
+
+namespace QmVk {
+
+static constexpr vk::DescriptorType g_descriptorTypes[DescriptorHeap::BindingsCount] = {
+    vk::DescriptorType::eCombinedImageSampler,
+    vk::DescriptorType::eStorageImage,
+    vk::DescriptorType::eStorageBuffer,
+};
+
+shared_ptr<DescriptorHeap> DescriptorHeap::create(
+    const shared_ptr<Device> &device,
+    uint32_t maxSampledImages,
+    uint32_t maxStorageImages,
+    uint32_t maxStorageBuffers)
+{
+    auto descriptorHeap = make_shared<DescriptorHeap>(
+        device,
+        maxSampledImages,
+        maxStorageImages,
+        maxStorageBuffers
+    );
+    descriptorHeap->init();
+    return descriptorHeap;
+}
+
+DescriptorHeap::DescriptorHeap(
+    const shared_ptr<Device> &device,
+    uint32_t maxSampledImages,
+    uint32_t maxStorageImages,
+    uint32_t maxStorageBuffers)
+    : m_device(device)
+{
+    m_arrays[SampledImages].size = maxSampledImages;
+    m_arrays[StorageImages].size = maxStorageImages;
+    m_arrays[StorageBuffers].size = maxStorageBuffers;
+}
+DescriptorHeap::~DescriptorHeap()
+{
+}
+
+void DescriptorHeap::init()
+{
+    if (!m_device->hasDescriptorIndexing())
+        throw vk::LogicError("Descriptor indexing is not enabled");
+
+    vector<vk::DescriptorSetLayoutBinding> descriptorSetLayoutBindings;
+    vector<vk::DescriptorBindingFlags> descriptorBindingFlags;
+    vector<vk::DescriptorPoolSize> descriptorPoolSizes;
+    for (uint32_t i = 0; i < BindingsCount; ++i)
+    {
+        const uint32_t size = m_arrays[i].size;
+        if (size == 0)
+            continue;
+
+        vk::DescriptorSetLayoutBinding descriptorSetLayoutBinding;
+        descriptorSetLayoutBinding.binding = i;
+        descriptorSetLayoutBinding.descriptorType = g_descriptorTypes[i];
+        descriptorSetLayoutBinding.descriptorCount = size;
+        descriptorSetLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eAll;
+        descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+        descriptorBindingFlags.push_back(
+            vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+            vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending |
+            vk::DescriptorBindingFlagBits::ePartiallyBound
+        );
+
+        vk::DescriptorPoolSize descriptorPoolSize;
+        descriptorPoolSize.type = g_descriptorTypes[i];
+        descriptorPoolSize.descriptorCount = size;
+        descriptorPoolSizes.push_back(descriptorPoolSize);
+    }
+    if (descriptorSetLayoutBindings.empty())
+        throw vk::LogicError("Empty descriptor heap");
+
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo descriptorSetLayoutBindingFlagsCreateInfo;
+    descriptorSetLayoutBindingFlagsCreateInfo.bindingCount = descriptorBindingFlags.size();
+    descriptorSetLayoutBindingFlagsCreateInfo.pBindingFlags = descriptorBindingFlags.data();
+
+    vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+    descriptorSetLayoutCreateInfo.pNext = &descriptorSetLayoutBindingFlagsCreateInfo;
+    descriptorSetLayoutCreateInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+    descriptorSetLayoutCreateInfo.bindingCount = descriptorSetLayoutBindings.size();
+    descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings.data();
+    m_descriptorSetLayout = m_device->createDescriptorSetLayoutUnique(descriptorSetLayoutCreateInfo, nullptr, m_device->dld());
+
+    vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
+    descriptorPoolCreateInfo.flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind;
+    descriptorPoolCreateInfo.maxSets = 1;
+    descriptorPoolCreateInfo.poolSizeCount = descriptorPoolSizes.size();
+    descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
+    m_descriptorPool = m_device->createDescriptorPoolUnique(descriptorPoolCreateInfo, nullptr, m_device->dld());
+
+    vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
+    descriptorSetAllocateInfo.descriptorPool = *m_descriptorPool;
+    descriptorSetAllocateInfo.descriptorSetCount = 1;
+    descriptorSetAllocateInfo.pSetLayouts = &*m_descriptorSetLayout;
+    m_descriptorSet = m_device->allocateDescriptorSets(descriptorSetAllocateInfo, m_device->dld())[0];
+}
+
+#ifndef QMVK_NO_GRAPHICS
+uint32_t DescriptorHeap::addSampledImage(
+    const shared_ptr<Image> &image,
+    const shared_ptr<Sampler> &sampler,
+    uint32_t plane)
+{
+    if (!image->isSampled() || plane >= image->numPlanes())
+        throw vk::LogicError("Bad image for descriptor heap");
+    if (sampler->samplerYcbcr() || image->samplerYcbcr())
+        throw vk::LogicError("YCbCr images can't be used in descriptor heap");
+
+    if (!image->hasImageViews())
+        image->recreateImageViews();
+
+    const vk::DescriptorImageInfo descriptorImageInfo(
+        *sampler,
+        image->imageView(plane),
+        vk::ImageLayout::eShaderReadOnlyOptimal
+    );
+    return add(
+        SampledImages,
+        Key(image.get(), sampler.get(), plane, 0),
+        {{}, image, sampler},
+        &descriptorImageInfo,
+        nullptr
+    );
+}
+uint32_t DescriptorHeap::addStorageImage(
+    const shared_ptr<Image> &image,
+    uint32_t plane)
+{
+    if (!image->isStorage() || plane >= image->numPlanes())
+        throw vk::LogicError("Bad image for descriptor heap");
+    if (image->samplerYcbcr())
+        throw vk::LogicError("YCbCr images can't be used in descriptor heap");
+
+    if (!image->hasImageViews())
+        image->recreateImageViews();
+
+    const vk::DescriptorImageInfo descriptorImageInfo(
+        vk::Sampler(),
+        image->imageView(plane),
+        vk::ImageLayout::eGeneral
+    );
+    return add(
+        StorageImages,
+        Key(image.get(), nullptr, plane, 0),
+        {{}, image, nullptr},
+        &descriptorImageInfo,
+        nullptr
+    );
+}
+#endif
+uint32_t DescriptorHeap::addStorageBuffer(
+    const shared_ptr<Buffer> &buffer,
+    vk::DeviceSize offset,
+    vk::DeviceSize range)
+{
+    if (offset >= buffer->size() || (range != VK_WHOLE_SIZE && offset + range > buffer->size()))
+        throw vk::LogicError("Buffer range exceeds the buffer size");
+
+    const vk::DescriptorBufferInfo descriptorBufferInfo(
+        *buffer,
+        offset,
+        range
+    );
+    return add(
+        StorageBuffers,
+        Key(buffer.get(), nullptr, offset, range),
+        {{}, buffer, nullptr},
+        nullptr,
+        &descriptorBufferInfo
+    );
+}
+
+void DescriptorHeap::remove(Binding binding, uint32_t index)
+{
+    lock_guard<mutex> locker(m_mutex);
+
+    auto &array = m_arrays[binding];
+    if (index >= array.slots.size() || !array.slots[index].object)
+        throw vk::LogicError("Bad descriptor heap index");
+
+    auto &slot = array.slots[index];
+    array.indexes.erase(slot.key);
+    slot = Slot();
+    array.freeIndexes.push_back(index);
+}
+
+uint32_t DescriptorHeap::add(
+    Binding binding,
+    const Key &key,
+    Slot &&slot,
+    const vk::DescriptorImageInfo *imageInfo,
+    const vk::DescriptorBufferInfo *bufferInfo)
+{
+    lock_guard<mutex> locker(m_mutex);
+
+    auto &array = m_arrays[binding];
+
+    auto it = array.indexes.find(key);
+    if (it != array.indexes.end())
+        return it->second;
+
+    uint32_t index = 0;
+    if (!array.freeIndexes.empty())
+    {
+        index = array.freeIndexes.back();
+        array.freeIndexes.pop_back();
+    }
+    else if (array.slots.size() < array.size)
+    {
+        index = array.slots.size();
+        array.slots.emplace_back();
+    }
+    else
+    {
+        throw vk::LogicError("Descriptor heap is full");
+    }
+
+    vk::WriteDescriptorSet writeDescriptorSet;
+    writeDescriptorSet.dstSet = m_descriptorSet;
+    writeDescriptorSet.dstBinding = binding;
+    writeDescriptorSet.dstArrayElement = index;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.descriptorType = g_descriptorTypes[binding];
+    writeDescriptorSet.pImageInfo = imageInfo;
+    writeDescriptorSet.pBufferInfo = bufferInfo;
+    m_device->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr, m_device->dld());
+
+    slot.key = key;
+    array.slots[index] = move(slot);
+    array.indexes.emplace(key, index);
+
+    return index;
+}
+
+}
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <map>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+class Buffer;
+#ifndef QMVK_NO_GRAPHICS
+class Image;
+class Sampler;
+#endif
+
+// Bindless descriptor set with large, partially bound and update-after-bind arrays:
+//  - binding 0: combined image samplers,
+//  - binding 1: storage images,
+//  - binding 2: storage buffers.
+// Objects get a stable index in their array until they're removed, shaders receive
+// the indexes via push constants. Images must be in the proper layout when used,
+// they can be prepared with "Pipeline::prepareObjects()".
+// Requires "Device::hasDescriptorIndexing()".
+class QMVK_EXPORT DescriptorHeap
+{
+    using Key = tuple<const void *, const void *, vk::DeviceSize, vk::DeviceSize>;
+
+    struct Slot
+    {
+        Key key;
+        shared_ptr<void> object;
+        shared_ptr<void> sampler;
+    };
+
+    struct Array
+    {
+        uint32_t size = 0;
+        vector<Slot> slots;
+        vector<uint32_t> freeIndexes;
+        map<Key, uint32_t> indexes;
+    };
+
+public:
+    enum Binding : uint32_t
+    {
+        SampledImages,
+        StorageImages,
+        StorageBuffers,
+
+        BindingsCount
+    };
+
+public:
+    static shared_ptr<DescriptorHeap> create(
+        const shared_ptr<Device> &device,
+        uint32_t maxSampledImages = 4096,
+        uint32_t maxStorageImages = 1024,
+        uint32_t maxStorageBuffers = 1024
+    );
+
+public:
+    DescriptorHeap(
+        const shared_ptr<Device> &device,
+        uint32_t maxSampledImages,
+        uint32_t maxStorageImages,
+        uint32_t maxStorageBuffers
+    );
+    ~DescriptorHeap();
+
+private:
+    void init();
+
+public:
+    inline shared_ptr<Device> device() const;
+
+    inline uint32_t size(Binding binding) const;
+
+    inline vk::DescriptorSetLayout descriptorSetLayout() const;
+    inline vk::DescriptorSet descriptorSet() const;
+
+#ifndef QMVK_NO_GRAPHICS
+    // Adding the same object again returns the same index
+    uint32_t addSampledImage(
+        const shared_ptr<Image> &image,
+        const shared_ptr<Sampler> &sampler,
+        uint32_t plane = 0
+    );
+    uint32_t addStorageImage(
+        const shared_ptr<Image> &image,
+        uint32_t plane = 0
+    );
+#endif
+    uint32_t addStorageBuffer(
+        const shared_ptr<Buffer> &buffer,
+        vk::DeviceSize offset = 0,
+        vk::DeviceSize range = VK_WHOLE_SIZE
+    );
+
+    // The index can be reused immediately, so it must not be used by any pending command buffer
+    void remove(Binding binding, uint32_t index);
+
+private:
+    uint32_t add(
+        Binding binding,
+        const Key &key,
+        Slot &&slot,
+        const vk::DescriptorImageInfo *imageInfo,
+        const vk::DescriptorBufferInfo *bufferInfo
+    );
+
+private:
+    const shared_ptr<Device> m_device;
+
+    mutex m_mutex;
+    Array m_arrays[BindingsCount];
+
+    vk::UniqueDescriptorSetLayout m_descriptorSetLayout;
+    vk::UniqueDescriptorPool m_descriptorPool;
+    vk::DescriptorSet m_descriptorSet;
+};
+
+/* Inline implementation */
+
+shared_ptr<Device> DescriptorHeap::device() const
+{
+    return m_device;
+}
+
+uint32_t DescriptorHeap::size(Binding binding) const
+{
+    return m_arrays[binding].size;
+}
+
+vk::DescriptorSetLayout DescriptorHeap::descriptorSetLayout() const
+{
+    return *m_descriptorSetLayout;
+}
+vk::DescriptorSet DescriptorHeap::descriptorSet() const
+{
+    return m_descriptorSet;
+}
+
+}
@@ -7,6 +7,7 @@
 #include "DescriptorSet.hpp"
 #include "DescriptorInfo.hpp"
 #include "DescriptorPool.hpp"
+#include "DescriptorAllocator.hpp"
 #include "Device.hpp"
 
 namespace QmVk {
@@ -20,65 +21,74 @@ shared_ptr<DescriptorSet> DescriptorSet::create(
     descriptor->init();
     return descriptor;
 }
+shared_ptr<DescriptorSet> DescriptorSet::create(
+    const shared_ptr<DescriptorSetLayout> &descriptorSetLayout)
+{
+    if (!DescriptorAllocator::canAllocate(*descriptorSetLayout))
+        return create(DescriptorPool::create(descriptorSetLayout));
+
+    auto descriptor = make_shared<DescriptorSet>(
+        descriptorSetLayout
+    );
+    descriptor->init();
+    return descriptor;
+}
 
 DescriptorSet::DescriptorSet(
     const shared_ptr<DescriptorPool> &descriptorPool)
     : m_descriptorPool(descriptorPool)
+    , m_descriptorSetLayout(m_descriptorPool->descriptorSetLayout())
 {}
-DescriptorSet::~DescriptorSet()
+DescriptorSet::DescriptorSet(
+    const shared_ptr<DescriptorSetLayout> &descriptorSetLayout)
+    : m_descriptorSetLayout(descriptorSetLayout)
 {}
+DescriptorSet::~DescriptorSet()
+{
+    if (!m_descriptorSet)
+        return;
+
+    auto device = m_descriptorSetLayout->device();
+    if (m_descriptorPool)
+        device->freeDescriptorSets(*m_descriptorPool, 1, &m_descriptorSet, device->dld());
+    else
+        device->descriptorAllocator()->free(*m_descriptorSetLayout, m_descriptorSet);
+}
 
 void DescriptorSet::init()
 {
-    auto descriptorSetLayout = m_descriptorPool->descriptorSetLayout();
-
-    if (descriptorSetLayout->isEmpty())
+    if (m_descriptorSetLayout->isEmpty())
         return;
 
-    auto device = descriptorSetLayout->device();
+    auto device = m_descriptorSetLayout->device();
+
+    if (!m_descriptorPool)
+    {
+        m_descriptorSet = device->descriptorAllocator()->allocate(*m_descriptorSetLayout);
+        return;
+    }
 
     vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
     descriptorSetAllocateInfo.descriptorPool = *m_descriptorPool;
     descriptorSetAllocateInfo.descriptorSetCount = 1;
-    descriptorSetAllocateInfo.pSetLayouts = *descriptorSetLayout;
-    m_descriptorSet = move(device->allocateDescriptorSetsUnique(descriptorSetAllocateInfo, device->dld())[0]);
+    descriptorSetAllocateInfo.pSetLayouts = *m_descriptorSetLayout;
+    m_descriptorSet = device->allocateDescriptorSets(descriptorSetAllocateInfo, device->dld())[0];
 }
 
 void DescriptorSet::updateDescriptorInfos(const vector<DescriptorInfo> &descriptorInfos)
 {
-    auto descriptorSetLayout = m_descriptorPool->descriptorSetLayout();
-    auto device = descriptorSetLayout->device();
-
-    const auto &descriptorTypes = descriptorSetLayout->descriptorTypes();
+    auto device = m_descriptorSetLayout->device();
 
-    vector<vk::WriteDescriptorSet> writeDescriptorSets;
-    writeDescriptorSets.resize(descriptorInfos.size());
-    for (uint32_t t = 0, i = 0; t < descriptorTypes.size(); ++t)
+    if (const auto descriptorUpdateTemplate = m_descriptorSetLayout->descriptorUpdateTemplate())
     {
-        const uint32_t arrSize = descriptorTypes[t].descriptorCount;
-        for (uint32_t e = 0; e < arrSize; ++e, ++i)
-        {
-            vk::WriteDescriptorSet &writeDescriptorSet = writeDescriptorSets[i];
-            writeDescriptorSet.dstSet = *m_descriptorSet;
-            writeDescriptorSet.dstBinding = t;
-            writeDescriptorSet.dstArrayElement = e;
-            writeDescriptorSet.descriptorCount = 1;
-            writeDescriptorSet.descriptorType = descriptorTypes[t].type;
-            switch (descriptorInfos[i].type)
-            {
-                case DescriptorInfo::Type::DescriptorImageInfo:
-                    writeDescriptorSet.pImageInfo = &descriptorInfos[i].descrImgInfo;
-                    break;
-                case DescriptorInfo::Type::DescriptorBufferInfo:
-                    writeDescriptorSet.pBufferInfo = &descriptorInfos[i].descrBuffInfo;
-                    break;
-                case DescriptorInfo::Type::BufferView:
-                    writeDescriptorSet.pTexelBufferView = &descriptorInfos[i].bufferView;
-                    break;
-            }
-        }
+        if (descriptorInfos.size() != m_descriptorSetLayout->descriptorsCount())
+            throw vk::LogicError("Descriptor infos count doesn't match the descriptor set layout");
+
+        device->updateDescriptorSetWithTemplate(m_descriptorSet, descriptorUpdateTemplate, descriptorInfos.data(), device->dld());
+        return;
     }
 
+    const auto writeDescriptorSets = m_descriptorSetLayout->getWriteDescriptorSets(descriptorInfos, m_descriptorSet);
     device->updateDescriptorSets(writeDescriptorSets, nullptr, device->dld());
 }
 
@@ -25,18 +25,27 @@ public:
     static shared_ptr<DescriptorSet> create(
         const shared_ptr<DescriptorPool> &descriptorPool
     );
+    // Allocates from device shared descriptor pools if possible
+    static shared_ptr<DescriptorSet> create(
+        const shared_ptr<DescriptorSetLayout> &descriptorSetLayout
+    );
 
 public:
     DescriptorSet(
         const shared_ptr<DescriptorPool> &descriptorPool
     );
+    DescriptorSet(
+        const shared_ptr<DescriptorSetLayout> &descriptorSetLayout
+    );
     ~DescriptorSet();
 
 private:
     void init();
 
 public:
+    // Null if allocated from device shared descriptor pools
     inline shared_ptr<DescriptorPool> descriptorPool() const;
+    inline shared_ptr<DescriptorSetLayout> descriptorSetLayout() const;
 
     void updateDescriptorInfos(const vector<DescriptorInfo> &descriptorInfos);
 
@@ -45,8 +54,9 @@ public:
 
 private:
     const shared_ptr<DescriptorPool> m_descriptorPool;
+    const shared_ptr<DescriptorSetLayout> m_descriptorSetLayout;
 
-    vk::UniqueDescriptorSet m_descriptorSet;
+    vk::DescriptorSet m_descriptorSet;
 };
 
 /* Inline implementation */
@@ -55,10 +65,14 @@ shared_ptr<DescriptorPool> DescriptorSet::descriptorPool() const
 {
     return m_descriptorPool;
 }
+shared_ptr<DescriptorSetLayout> DescriptorSet::descriptorSetLayout() const
+{
+    return m_descriptorSetLayout;
+}
 
 DescriptorSet::operator vk::DescriptorSet() const
 {
-    return *m_descriptorSet;
+    return m_descriptorSet;
 }
 
 }
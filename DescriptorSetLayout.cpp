@@ -5,17 +5,23 @@
 */
 
 #include "DescriptorSetLayout.hpp"
+#include "DescriptorInfo.hpp"
 #include "Device.hpp"
 
+#include <type_traits>
+#include <cstddef>
+
 namespace QmVk {
 
 shared_ptr<DescriptorSetLayout> DescriptorSetLayout::create(
     const shared_ptr<Device> &device,
-    const vector<DescriptorType> &descriptorTypes)
+    const vector<DescriptorType> &descriptorTypes,
+    bool pushDescriptor)
 {
     auto descriptorSetLayout = make_shared<DescriptorSetLayout>(
         device,
-        descriptorTypes
+        descriptorTypes,
+        pushDescriptor
     );
     descriptorSetLayout->init();
     return descriptorSetLayout;
@@ -23,9 +29,11 @@ shared_ptr<DescriptorSetLayout> DescriptorSetLayout::create(
 
 DescriptorSetLayout::DescriptorSetLayout(
     const shared_ptr<Device> &device,
-    const vector<DescriptorType> &descriptorTypes)
+    const vector<DescriptorType> &descriptorTypes,
+    bool pushDescriptor)
     : m_device(device)
     , m_descriptorTypes(descriptorTypes)
+    , m_pushDescriptor(pushDescriptor)
 {
 }
 DescriptorSetLayout::~DescriptorSetLayout()
@@ -33,6 +41,14 @@ DescriptorSetLayout::~DescriptorSetLayout()
 }
 
 void DescriptorSetLayout::init()
+{
+    m_descriptorSetLayout = createDescriptorSetLayout();
+
+    if (!m_pushDescriptor && !m_descriptorTypes.empty() && m_device->hasDescriptorUpdateTemplate())
+        createDescriptorUpdateTemplate();
+}
+
+vk::UniqueDescriptorSetLayout DescriptorSetLayout::createDescriptorSetLayout() const
 {
     vector<vk::DescriptorSetLayoutBinding> descriptorSetLayoutBindings;
     descriptorSetLayoutBindings.reserve(m_descriptorTypes.size());
@@ -49,9 +65,100 @@ void DescriptorSetLayout::init()
         descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
     }
     vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+    if (m_pushDescriptor)
+        descriptorSetLayoutCreateInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR;
     descriptorSetLayoutCreateInfo.bindingCount = descriptorSetLayoutBindings.size();
     descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings.data();
-    m_descriptorSetLayout = m_device->createDescriptorSetLayoutUnique(descriptorSetLayoutCreateInfo, nullptr, m_device->dld());
+    return m_device->createDescriptorSetLayoutUnique(descriptorSetLayoutCreateInfo, nullptr, m_device->dld());
+}
+
+void DescriptorSetLayout::createDescriptorUpdateTemplate()
+{
+    static_assert(is_standard_layout_v<DescriptorInfo>);
+
+    vector<vk::DescriptorUpdateTemplateEntry> descriptorUpdateTemplateEntries;
+    descriptorUpdateTemplateEntries.reserve(m_descriptorTypes.size());
+    for (uint32_t t = 0, i = 0; t < m_descriptorTypes.size(); ++t)
+    {
+        const auto &descriptorType = m_descriptorTypes[t];
+
+        size_t offset = 0;
+        switch (descriptorType.type)
+        {
+            case vk::DescriptorType::eSampler:
+            case vk::DescriptorType::eCombinedImageSampler:
+            case vk::DescriptorType::eSampledImage:
+            case vk::DescriptorType::eStorageImage:
+            case vk::DescriptorType::eInputAttachment:
+                offset = offsetof(DescriptorInfo, descrImgInfo);
+                break;
+            case vk::DescriptorType::eUniformTexelBuffer:
+            case vk::DescriptorType::eStorageTexelBuffer:
+                offset = offsetof(DescriptorInfo, bufferView);
+                break;
+            case vk::DescriptorType::eUniformBuffer:
+            case vk::DescriptorType::eStorageBuffer:
+            case vk::DescriptorType::eUniformBufferDynamic:
+            case vk::DescriptorType::eStorageBufferDynamic:
+                offset = offsetof(DescriptorInfo, descrBuffInfo);
+                break;
+            default:
+                // Not representable by "DescriptorInfo", use regular writes
+                return;
+        }
+
+        vk::DescriptorUpdateTemplateEntry descriptorUpdateTemplateEntry;
+        descriptorUpdateTemplateEntry.dstBinding = t;
+        descriptorUpdateTemplateEntry.dstArrayElement = 0;
+        descriptorUpdateTemplateEntry.descriptorCount = descriptorType.descriptorCount;
+        descriptorUpdateTemplateEntry.descriptorType = descriptorType.type;
+        descriptorUpdateTemplateEntry.offset = i * sizeof(DescriptorInfo) + offset;
+        descriptorUpdateTemplateEntry.stride = sizeof(DescriptorInfo);
+        descriptorUpdateTemplateEntries.push_back(descriptorUpdateTemplateEntry);
+
+        i += descriptorType.descriptorCount;
+    }
+
+    vk::DescriptorUpdateTemplateCreateInfo descriptorUpdateTemplateCreateInfo;
+    descriptorUpdateTemplateCreateInfo.descriptorUpdateEntryCount = descriptorUpdateTemplateEntries.size();
+    descriptorUpdateTemplateCreateInfo.pDescriptorUpdateEntries = descriptorUpdateTemplateEntries.data();
+    descriptorUpdateTemplateCreateInfo.templateType = vk::DescriptorUpdateTemplateType::eDescriptorSet;
+    descriptorUpdateTemplateCreateInfo.descriptorSetLayout = *m_descriptorSetLayout;
+    m_descriptorUpdateTemplate = m_device->createDescriptorUpdateTemplateUnique(descriptorUpdateTemplateCreateInfo, nullptr, m_device->dld());
+}
+
+vector<vk::WriteDescriptorSet> DescriptorSetLayout::getWriteDescriptorSets(
+    const vector<DescriptorInfo> &descriptorInfos,
+    vk::DescriptorSet dstSet) const
+{
+    vector<vk::WriteDescriptorSet> writeDescriptorSets;
+    writeDescriptorSets.resize(descriptorInfos.size());
+    for (uint32_t t = 0, i = 0; t < m_descriptorTypes.size(); ++t)
+    {
+        const uint32_t arrSize = m_descriptorTypes[t].descriptorCount;
+        for (uint32_t e = 0; e < arrSize; ++e, ++i)
+        {
+            vk::WriteDescriptorSet &writeDescriptorSet = writeDescriptorSets[i];
+            writeDescriptorSet.dstSet = dstSet;
+            writeDescriptorSet.dstBinding = t;
+            writeDescriptorSet.dstArrayElement = e;
+            writeDescriptorSet.descriptorCount = 1;
+            writeDescriptorSet.descriptorType = m_descriptorTypes[t].type;
+            switch (descriptorInfos[i].type)
+            {
+                case DescriptorInfo::Type::DescriptorImageInfo:
+                    writeDescriptorSet.pImageInfo = &descriptorInfos[i].descrImgInfo;
+                    break;
+                case DescriptorInfo::Type::DescriptorBufferInfo:
+                    writeDescriptorSet.pBufferInfo = &descriptorInfos[i].descrBuffInfo;
+                    break;
+                case DescriptorInfo::Type::BufferView:
+                    writeDescriptorSet.pTexelBufferView = &descriptorInfos[i].bufferView;
+                    break;
+            }
+        }
+    }
+    return writeDescriptorSets;
 }
 
 }
@@ -16,6 +16,7 @@ namespace QmVk {
 
 using namespace std;
 
+class DescriptorInfo;
 class Device;
 
 class QMVK_EXPORT DescriptorSetLayout
@@ -23,24 +24,43 @@ class QMVK_EXPORT DescriptorSetLayout
 public:
     static shared_ptr<DescriptorSetLayout> create(
         const shared_ptr<Device> &device,
-        const vector<DescriptorType> &descriptorTypes
+        const vector<DescriptorType> &descriptorTypes,
+        bool pushDescriptor = false
     );
 
 public:
     DescriptorSetLayout(
         const shared_ptr<Device> &device,
-        const vector<DescriptorType> &descriptorTypes
+        const vector<DescriptorType> &descriptorTypes,
+        bool pushDescriptor
     );
     ~DescriptorSetLayout();
 
 private:
     void init();
 
+    void createDescriptorUpdateTemplate();
+
 public:
     inline shared_ptr<Device> device() const;
 
     inline bool isEmpty() const;
     inline const vector<DescriptorType> &descriptorTypes() const;
+    inline uint32_t descriptorsCount() const;
+
+    inline bool isPushDescriptor() const;
+
+    // Null if not supported, the template reads data directly from "vector<DescriptorInfo>"
+    inline vk::DescriptorUpdateTemplate descriptorUpdateTemplate() const;
+
+    // Creates a new layout identically defined to this one, so it's compatible with it
+    vk::UniqueDescriptorSetLayout createDescriptorSetLayout() const;
+
+    // One write per descriptor, "descriptorInfos" must outlive the returned writes
+    vector<vk::WriteDescriptorSet> getWriteDescriptorSets(
+        const vector<DescriptorInfo> &descriptorInfos,
+        vk::DescriptorSet dstSet = {}
+    ) const;
 
 public:
     inline operator const vk::DescriptorSetLayout *() const;
@@ -48,8 +68,10 @@ public:
 private:
     const shared_ptr<Device> m_device;
     const vector<DescriptorType> m_descriptorTypes;
+    const bool m_pushDescriptor;
 
     vk::UniqueDescriptorSetLayout m_descriptorSetLayout;
+    vk::UniqueDescriptorUpdateTemplate m_descriptorUpdateTemplate;
 };
 
 /* Inline implementation */
@@ -67,6 +89,23 @@ const vector<DescriptorType> &DescriptorSetLayout::descriptorTypes() const
 {
     return m_descriptorTypes;
 }
+uint32_t DescriptorSetLayout::descriptorsCount() const
+{
+    uint32_t count = 0;
+    for (auto &&descriptorType : m_descriptorTypes)
+        count += descriptorType.descriptorCount;
+    return count;
+}
+
+bool DescriptorSetLayout::isPushDescriptor() const
+{
+    return m_pushDescriptor;
+}
+
+vk::DescriptorUpdateTemplate DescriptorSetLayout::descriptorUpdateTemplate() const
+{
+    return *m_descriptorUpdateTemplate;
+}
 
 DescriptorSetLayout::operator const vk::DescriptorSetLayout *() const
 {
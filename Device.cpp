@@ -7,6 +7,11 @@
 #include "Device.hpp"
 #include "AbstractInstance.hpp"
 #include "PhysicalDevice.hpp"
+#include "MemoryAllocator.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineObjectCache.hpp"
+#include "DescriptorAllocator.hpp"
+#include "CommandPoolManager.hpp"
 #include "Queue.hpp"
 
 #include <cstring>
@@ -19,6 +24,11 @@ Device::Device(const shared_ptr<PhysicalDevice> &physicalDevice)
 {}
 Device::~Device()
 {
+    m_commandPoolManager.reset();
+    m_descriptorAllocator.reset();
+    m_pipelineObjectCache.reset();
+    m_pipelineCache.reset();
+    m_memoryAllocator.reset();
     if (*this)
         destroy(nullptr, dld());
 }
@@ -86,14 +96,59 @@ void Device::init(const vk::PhysicalDeviceFeatures2 &features,
         deviceCreateInfo.pEnabledFeatures = &features.features;
     static_cast<vk::Device &>(*this) = m_physicalDevice->createDevice(deviceCreateInfo, nullptr, dld());
 
+    m_hasDescriptorUpdateTemplate = (!m_physicalDevice->isVk10() || hasExtension(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME));
+    m_hasDedicatedAllocation = (!m_physicalDevice->isVk10() || (hasExtension(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME) && hasExtension(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME)));
+
+    m_memoryAllocator = make_unique<MemoryAllocator>(*this);
+    m_pipelineCache = make_unique<PipelineCache>(*this);
+    m_pipelineObjectCache = make_unique<PipelineObjectCache>();
+    m_descriptorAllocator = make_unique<DescriptorAllocator>(*this);
+    m_commandPoolManager = make_unique<CommandPoolManager>(*this);
+
     if (hasPhysDevs2Props)
     {
         const auto version = m_physicalDevice->version();
         const bool hasV11 = (version.first > 1 || version.second >= 1);
+        const bool hasV12 = (version.first > 1 || version.second >= 2);
         const bool hasV13 = (version.first > 1 || version.second >= 3);
 
         const bool ycbcr = (hasV11 || hasExtension(VK_KHR_SAMPLER_YCBCR_CONVERSION_EXTENSION_NAME));
         const bool sync2 = (hasV13 || hasExtension(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME));
+        const bool descriptorIndexing = (hasV12 || hasExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME));
+        const bool dynamicRendering = (hasV13 || hasExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME));
+        const bool timelineSemaphore = (hasV12 || hasExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME));
+
+        if (hasExtension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+        {
+            if (instance->isVk10())
+            {
+                m_maxPushDescriptors = m_physicalDevice->getProperties2KHR<
+                    vk::PhysicalDeviceProperties2,
+                    vk::PhysicalDevicePushDescriptorPropertiesKHR
+                >(dld()).get<vk::PhysicalDevicePushDescriptorPropertiesKHR>().maxPushDescriptors;
+            }
+            else
+            {
+                m_maxPushDescriptors = m_physicalDevice->getProperties2<
+                    vk::PhysicalDeviceProperties2,
+                    vk::PhysicalDevicePushDescriptorPropertiesKHR
+                >(dld()).get<vk::PhysicalDevicePushDescriptorPropertiesKHR>().maxPushDescriptors;
+            }
+        }
+
+        // Features required by "DescriptorHeap"
+        auto checkDescriptorIndexing = [&](const auto &features) {
+            if (!descriptorIndexing)
+                return;
+            m_hasDescriptorIndexing =
+                   features.descriptorBindingSampledImageUpdateAfterBind
+                && features.descriptorBindingStorageImageUpdateAfterBind
+                && features.descriptorBindingStorageBufferUpdateAfterBind
+                && features.descriptorBindingUpdateUnusedWhilePending
+                && features.descriptorBindingPartiallyBound
+                && features.runtimeDescriptorArray
+            ;
+        };
 
         auto pNext = reinterpret_cast<vk::BaseOutStructure *>(features.pNext);
         while (pNext)
@@ -108,6 +163,27 @@ void Device::init(const vk::PhysicalDeviceFeatures2 &features,
                     if (sync2 && reinterpret_cast<vk::PhysicalDeviceSynchronization2FeaturesKHR *>(pNext)->synchronization2)
                         m_hasSync2 = true;
                     break;
+                case vk::StructureType::ePhysicalDeviceDynamicRenderingFeatures:
+                    if (dynamicRendering && reinterpret_cast<vk::PhysicalDeviceDynamicRenderingFeatures *>(pNext)->dynamicRendering)
+                        m_hasDynamicRendering = true;
+                    break;
+                case vk::StructureType::ePhysicalDeviceVulkan13Features:
+                    if (hasV13 && reinterpret_cast<vk::PhysicalDeviceVulkan13Features *>(pNext)->dynamicRendering)
+                        m_hasDynamicRendering = true;
+                    break;
+                case vk::StructureType::ePhysicalDeviceDescriptorIndexingFeatures:
+                    checkDescriptorIndexing(*reinterpret_cast<vk::PhysicalDeviceDescriptorIndexingFeatures *>(pNext));
+                    break;
+                case vk::StructureType::ePhysicalDeviceTimelineSemaphoreFeatures:
+                    if (timelineSemaphore && reinterpret_cast<vk::PhysicalDeviceTimelineSemaphoreFeatures *>(pNext)->timelineSemaphore)
+                        m_hasTimelineSemaphore = true;
+                    break;
+                case vk::StructureType::ePhysicalDeviceVulkan12Features:
+                    if (hasV12 && reinterpret_cast<vk::PhysicalDeviceVulkan12Features *>(pNext)->descriptorIndexing)
+                        checkDescriptorIndexing(*reinterpret_cast<vk::PhysicalDeviceVulkan12Features *>(pNext));
+                    if (hasV12 && reinterpret_cast<vk::PhysicalDeviceVulkan12Features *>(pNext)->timelineSemaphore)
+                        m_hasTimelineSemaphore = true;
+                    break;
                 default:
                     break;
             }
@@ -21,6 +21,11 @@ using namespace std;
 
 class PhysicalDevice;
 class MemoryPropertyFlags;
+class MemoryAllocator;
+class PipelineCache;
+class PipelineObjectCache;
+class DescriptorAllocator;
+class CommandPoolManager;
 class Queue;
 
 class QMVK_EXPORT Device : public vk::Device, public enable_shared_from_this<Device>
@@ -47,6 +52,19 @@ public:
 
     inline bool hasYcbcr() const;
     inline bool hasSync2() const;
+    inline bool hasDescriptorUpdateTemplate() const;
+    inline bool hasDescriptorIndexing() const;
+    inline bool hasDynamicRendering() const;
+    inline bool hasTimelineSemaphore() const;
+    inline bool hasDedicatedAllocation() const;
+
+    // Zero if push descriptors are not enabled
+    inline uint32_t maxPushDescriptors() const;
+
+    // Buffers and images created afterwards use exclusive sharing even if many queue families
+    // are enabled. Queue family ownership must be transferred with "releaseOwnership()".
+    inline void setExclusiveSharing(bool exclusiveSharing);
+    inline bool isExclusiveSharing() const;
 
     inline const auto &queues() const;
 
@@ -57,6 +75,12 @@ public:
     shared_ptr<Queue> queue(uint32_t queueFamilyIndex, uint32_t index);
     inline shared_ptr<Queue> firstQueue();
 
+    inline MemoryAllocator *memoryAllocator() const;
+    inline PipelineCache *pipelineCache() const;
+    inline PipelineObjectCache *pipelineObjectCache() const;
+    inline DescriptorAllocator *descriptorAllocator() const;
+    inline CommandPoolManager *commandPoolManager() const;
+
 private:
     const shared_ptr<PhysicalDevice> m_physicalDevice;
     const vk::detail::DispatchLoaderDynamic &m_dld;
@@ -64,11 +88,24 @@ private:
     unordered_set<string> m_enabledExtensions;
     bool m_hasYcbcr = false;
     bool m_hasSync2 = false;
+    bool m_hasDescriptorUpdateTemplate = false;
+    bool m_hasDescriptorIndexing = false;
+    bool m_hasDynamicRendering = false;
+    bool m_hasTimelineSemaphore = false;
+    bool m_hasDedicatedAllocation = false;
+    uint32_t m_maxPushDescriptors = 0;
+    bool m_exclusiveSharing = false;
 
     vector<uint32_t> m_queues;
 
     mutex m_queueMutex;
     unordered_map<uint32_t, vector<weak_ptr<Queue>>> m_weakQueues;
+
+    unique_ptr<MemoryAllocator> m_memoryAllocator;
+    unique_ptr<PipelineCache> m_pipelineCache;
+    unique_ptr<PipelineObjectCache> m_pipelineObjectCache;
+    unique_ptr<DescriptorAllocator> m_descriptorAllocator;
+    unique_ptr<CommandPoolManager> m_commandPoolManager;
 };
 
 /* Inline implementation */
@@ -99,6 +136,40 @@ bool Device::hasSync2() const
 {
     return m_hasSync2;
 }
+bool Device::hasDescriptorUpdateTemplate() const
+{
+    return m_hasDescriptorUpdateTemplate;
+}
+bool Device::hasDescriptorIndexing() const
+{
+    return m_hasDescriptorIndexing;
+}
+bool Device::hasDynamicRendering() const
+{
+    return m_hasDynamicRendering;
+}
+bool Device::hasTimelineSemaphore() const
+{
+    return m_hasTimelineSemaphore;
+}
+bool Device::hasDedicatedAllocation() const
+{
+    return m_hasDedicatedAllocation;
+}
+
+uint32_t Device::maxPushDescriptors() const
+{
+    return m_maxPushDescriptors;
+}
+
+void Device::setExclusiveSharing(bool exclusiveSharing)
+{
+    m_exclusiveSharing = exclusiveSharing;
+}
+bool Device::isExclusiveSharing() const
+{
+    return m_exclusiveSharing;
+}
 
 const auto &Device::queues() const
 {
@@ -123,4 +194,25 @@ shared_ptr<Queue> Device::firstQueue()
     return queue(queueFamilyIndex(0), 0);
 }
 
+MemoryAllocator *Device::memoryAllocator() const
+{
+    return m_memoryAllocator.get();
+}
+PipelineCache *Device::pipelineCache() const
+{
+    return m_pipelineCache.get();
+}
+PipelineObjectCache *Device::pipelineObjectCache() const
+{
+    return m_pipelineObjectCache.get();
+}
+DescriptorAllocator *Device::descriptorAllocator() const
+{
+    return m_descriptorAllocator.get();
+}
+CommandPoolManager *Device::commandPoolManager() const
+{
+    return m_commandPoolManager.get();
+}
+
 }
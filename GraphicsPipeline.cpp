@@ -6,6 +6,8 @@
 
 #include "GraphicsPipeline.hpp"
 #include "Device.hpp"
+#include "PipelineCache.hpp"
+#include "PipelineObjectCache.hpp"
 #include "ShaderModule.hpp"
 #include "RenderPass.hpp"
 #include "CommandBuffer.hpp"
@@ -23,7 +25,9 @@ GraphicsPipeline::GraphicsPipeline(CreateInfo &createInfo)
     , m_vertexShaderModule(move(createInfo.vertexShaderModule))
     , m_fragmentShaderModule(move(createInfo.fragmentShaderModule))
     , m_renderPass(move(createInfo.renderPass))
+    , m_colorFormat(m_renderPass ? m_renderPass->format() : createInfo.colorFormat)
     , m_size(createInfo.size)
+    , m_dynamicViewport(createInfo.dynamicViewport)
     , m_vertexBindingDescrs(move(createInfo.vertexBindingDescrs))
     , m_vertexAttrDescrs(move(createInfo.vertexAttrDescrs))
 {
@@ -72,6 +76,9 @@ GraphicsPipeline::~GraphicsPipeline()
 
 void GraphicsPipeline::createPipeline()
 {
+    if (!m_renderPass && !m_device->hasDynamicRendering())
+        throw vk::LogicError("Graphics pipeline requires render pass or dynamic rendering");
+
     vk::Viewport viewport;
     viewport.width = m_size.width;
     viewport.height = m_size.height;
@@ -81,9 +88,24 @@ void GraphicsPipeline::createPipeline()
 
     vk::PipelineViewportStateCreateInfo viewportState;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
+
+    const vk::DynamicState dynamicStates[] = {
+        vk::DynamicState::eViewport,
+        vk::DynamicState::eScissor,
+    };
+    vk::PipelineDynamicStateCreateInfo dynamicState;
+
+    if (m_dynamicViewport)
+    {
+        dynamicState.dynamicStateCount = 2;
+        dynamicState.pDynamicStates = dynamicStates;
+    }
+    else
+    {
+        viewportState.pViewports = &viewport;
+        viewportState.pScissors = &scissor;
+    }
 
     vk::PipelineMultisampleStateCreateInfo multisampling;
     multisampling.rasterizationSamples = vk::SampleCountFlagBits::e1;
@@ -128,9 +150,60 @@ void GraphicsPipeline::createPipeline()
     pipelineInfo.pRasterizationState = &m_rasterizer;
     pipelineInfo.pMultisampleState = &multisampling;
     pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.layout = *m_pipelineLayout;
-    pipelineInfo.renderPass = *m_renderPass;
-    m_pipeline = m_device->createGraphicsPipelineUnique(nullptr, pipelineInfo, nullptr, m_dld).value;
+    if (m_dynamicViewport)
+        pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = **m_pipelineLayout;
+
+    vk::PipelineRenderingCreateInfo pipelineRenderingCreateInfo;
+    if (m_renderPass)
+    {
+        pipelineInfo.renderPass = *m_renderPass;
+    }
+    else
+    {
+        pipelineRenderingCreateInfo.colorAttachmentCount = 1;
+        pipelineRenderingCreateInfo.pColorAttachmentFormats = &m_colorFormat;
+        pipelineInfo.pNext = &pipelineRenderingCreateInfo;
+    }
+
+    auto createPipeline = [&] {
+        return m_device->createGraphicsPipelineUnique(*m_device->pipelineCache(), pipelineInfo, nullptr, m_dld).value;
+    };
+
+    if (m_inputAssembly.pNext || m_rasterizer.pNext)
+    {
+        // Extension structures can't be compared
+        m_pipeline = make_shared<vk::UniquePipeline>(createPipeline());
+        return;
+    }
+
+    string key;
+    PipelineObjectCache::appendKey(key, m_vertexShaderModule->id());
+    PipelineObjectCache::appendKey(key, m_fragmentShaderModule->id());
+    PipelineObjectCache::appendKey(key, static_cast<bool>(m_renderPass));
+    PipelineObjectCache::appendKey(key, m_colorFormat); // Render passes with the same format are compatible
+    PipelineObjectCache::appendKey(key, m_dynamicViewport);
+    if (!m_dynamicViewport)
+        PipelineObjectCache::appendKey(key, m_size);
+    PipelineObjectCache::appendKey(key, m_vertexBindingDescrs);
+    PipelineObjectCache::appendKey(key, m_vertexAttrDescrs);
+    PipelineObjectCache::appendKey(key, m_colorBlendAttachment);
+    PipelineObjectCache::appendKey(key, m_inputAssembly.topology);
+    PipelineObjectCache::appendKey(key, m_inputAssembly.primitiveRestartEnable);
+    PipelineObjectCache::appendKey(key, m_rasterizer.depthClampEnable);
+    PipelineObjectCache::appendKey(key, m_rasterizer.rasterizerDiscardEnable);
+    PipelineObjectCache::appendKey(key, m_rasterizer.polygonMode);
+    PipelineObjectCache::appendKey(key, m_rasterizer.cullMode);
+    PipelineObjectCache::appendKey(key, m_rasterizer.frontFace);
+    PipelineObjectCache::appendKey(key, m_rasterizer.depthBiasEnable);
+    PipelineObjectCache::appendKey(key, m_rasterizer.depthBiasConstantFactor);
+    PipelineObjectCache::appendKey(key, m_rasterizer.depthBiasClamp);
+    PipelineObjectCache::appendKey(key, m_rasterizer.depthBiasSlopeFactor);
+    PipelineObjectCache::appendKey(key, m_rasterizer.lineWidth);
+    for (auto &&data : specializationData)
+        PipelineObjectCache::appendKey(key, data);
+
+    setPipeline(move(key), createPipeline);
 }
 
 void GraphicsPipeline::setCustomSpecializationDataVertex(const vector<uint32_t> &data)
@@ -144,8 +217,32 @@ void GraphicsPipeline::setCustomSpecializationDataFragment(const vector<uint32_t
 
 void GraphicsPipeline::recordCommands(const shared_ptr<CommandBuffer> &commandBuffer)
 {
+    if (m_dynamicViewport)
+    {
+        recordCommands(commandBuffer, m_size);
+        return;
+    }
+
     pushConstants(commandBuffer);
     bindObjects(commandBuffer, vk::PipelineBindPoint::eGraphics);
 }
+void GraphicsPipeline::recordCommands(const shared_ptr<CommandBuffer> &commandBuffer, const vk::Extent2D &size)
+{
+    if (!m_dynamicViewport)
+        throw vk::LogicError("Graphics pipeline has no dynamic viewport");
+
+    pushConstants(commandBuffer);
+    bindObjects(commandBuffer, vk::PipelineBindPoint::eGraphics);
+
+    vk::Viewport viewport;
+    viewport.width = size.width;
+    viewport.height = size.height;
+
+    vk::Rect2D scissor;
+    scissor.extent = size;
+
+    commandBuffer->setViewport(0, 1, &viewport, m_dld);
+    commandBuffer->setScissor(0, 1, &scissor, m_dld);
+}
 
 }
@@ -27,15 +27,17 @@ public:
         shared_ptr<Device> device;
         shared_ptr<ShaderModule> vertexShaderModule;
         shared_ptr<ShaderModule> fragmentShaderModule;
-        shared_ptr<RenderPass> renderPass;
+        shared_ptr<RenderPass> renderPass; // Can be empty with dynamic rendering
         vk::Extent2D size;
         // Optional
+        vk::Format colorFormat = vk::Format::eUndefined; // Dynamic rendering color attachment format if there is no "renderPass"
         uint32_t pushConstantsSize = 0;
         vector<vk::VertexInputBindingDescription> vertexBindingDescrs;
         vector<vk::VertexInputAttributeDescription> vertexAttrDescrs;
         vk::PipelineColorBlendAttachmentState *colorBlendAttachment = nullptr;
         vk::PipelineInputAssemblyStateCreateInfo *inputAssembly = nullptr;
         vk::PipelineRasterizationStateCreateInfo *rasterizer = nullptr;
+        bool dynamicViewport = false; // Viewport and scissor are set in "recordCommands()", "size" is the default
     };
 
 public:
@@ -50,17 +52,23 @@ private:
 
 public:
     inline vk::Extent2D size() const;
+    inline vk::Format colorFormat() const;
+    inline bool hasDynamicViewport() const;
 
     void setCustomSpecializationDataVertex(const vector<uint32_t> &data);
     void setCustomSpecializationDataFragment(const vector<uint32_t> &data);
 
     void recordCommands(const shared_ptr<CommandBuffer> &commandBuffer);
+    // Requires "dynamicViewport"
+    void recordCommands(const shared_ptr<CommandBuffer> &commandBuffer, const vk::Extent2D &size);
 
 private:
     const shared_ptr<ShaderModule> m_vertexShaderModule;
     const shared_ptr<ShaderModule> m_fragmentShaderModule;
     const shared_ptr<RenderPass> m_renderPass;
+    const vk::Format m_colorFormat;
     const vk::Extent2D m_size;
+    const bool m_dynamicViewport;
     const vector<vk::VertexInputBindingDescription> m_vertexBindingDescrs;
     const vector<vk::VertexInputAttributeDescription> m_vertexAttrDescrs;
     vk::PipelineColorBlendAttachmentState m_colorBlendAttachment;
@@ -74,5 +82,13 @@ vk::Extent2D GraphicsPipeline::size() const
 {
     return m_size;
 }
+vk::Format GraphicsPipeline::colorFormat() const
+{
+    return m_colorFormat;
+}
+bool GraphicsPipeline::hasDynamicViewport() const
+{
+    return m_dynamicViewport;
+}
 
 }
@@ -10,8 +10,9 @@
 #include "Device.hpp"
 #include "MemoryPropertyFlags.hpp"
 #include "CommandBuffer.hpp"
+#include "PipelineBarriers.hpp"
+#include "Buffer.hpp"
 #ifdef QMVK_USE_IMAGE_BUFFER_VIEW
-#   include "Buffer.hpp"
 #   include "BufferView.hpp"
 #endif
 
@@ -67,6 +68,91 @@ uint32_t Image::getNumPlanes(vk::Format format)
     return 1;
 }
 
+uint32_t Image::getTexelSize(vk::Format format)
+{
+    switch (format)
+    {
+        case vk::Format::eR8Unorm:
+        case vk::Format::eR8Snorm:
+        case vk::Format::eR8Uint:
+        case vk::Format::eR8Sint:
+        case vk::Format::eR8Srgb:
+        case vk::Format::eS8Uint:
+            return 1;
+        case vk::Format::eR8G8Unorm:
+        case vk::Format::eR8G8Snorm:
+        case vk::Format::eR8G8Uint:
+        case vk::Format::eR8G8Sint:
+        case vk::Format::eR8G8Srgb:
+        case vk::Format::eR16Unorm:
+        case vk::Format::eR16Snorm:
+        case vk::Format::eR16Uint:
+        case vk::Format::eR16Sint:
+        case vk::Format::eR16Sfloat:
+        case vk::Format::eR5G6B5UnormPack16:
+        case vk::Format::eB5G6R5UnormPack16:
+        case vk::Format::eR4G4B4A4UnormPack16:
+        case vk::Format::eB4G4R4A4UnormPack16:
+        case vk::Format::eR5G5B5A1UnormPack16:
+        case vk::Format::eB5G5R5A1UnormPack16:
+        case vk::Format::eA1R5G5B5UnormPack16:
+        case vk::Format::eD16Unorm:
+            return 2;
+        case vk::Format::eR8G8B8Unorm:
+        case vk::Format::eR8G8B8Srgb:
+        case vk::Format::eB8G8R8Unorm:
+        case vk::Format::eB8G8R8Srgb:
+            return 3;
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Snorm:
+        case vk::Format::eR8G8B8A8Uint:
+        case vk::Format::eR8G8B8A8Sint:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+        case vk::Format::eA8B8G8R8UnormPack32:
+        case vk::Format::eA8B8G8R8SrgbPack32:
+        case vk::Format::eA2R10G10B10UnormPack32:
+        case vk::Format::eA2B10G10R10UnormPack32:
+        case vk::Format::eB10G11R11UfloatPack32:
+        case vk::Format::eE5B9G9R9UfloatPack32:
+        case vk::Format::eR16G16Unorm:
+        case vk::Format::eR16G16Snorm:
+        case vk::Format::eR16G16Uint:
+        case vk::Format::eR16G16Sint:
+        case vk::Format::eR16G16Sfloat:
+        case vk::Format::eR32Uint:
+        case vk::Format::eR32Sint:
+        case vk::Format::eR32Sfloat:
+        case vk::Format::eX8D24UnormPack32:
+        case vk::Format::eD32Sfloat:
+            return 4;
+        case vk::Format::eR16G16B16Unorm:
+        case vk::Format::eR16G16B16Sfloat:
+            return 6;
+        case vk::Format::eR16G16B16A16Unorm:
+        case vk::Format::eR16G16B16A16Snorm:
+        case vk::Format::eR16G16B16A16Uint:
+        case vk::Format::eR16G16B16A16Sint:
+        case vk::Format::eR16G16B16A16Sfloat:
+        case vk::Format::eR32G32Uint:
+        case vk::Format::eR32G32Sint:
+        case vk::Format::eR32G32Sfloat:
+            return 8;
+        case vk::Format::eR32G32B32Uint:
+        case vk::Format::eR32G32B32Sint:
+        case vk::Format::eR32G32B32Sfloat:
+            return 12;
+        case vk::Format::eR32G32B32A32Uint:
+        case vk::Format::eR32G32B32A32Sint:
+        case vk::Format::eR32G32B32A32Sfloat:
+            return 16;
+        default:
+            break;
+    }
+    return 0;
+}
+
 vk::ExternalMemoryProperties Image::getExternalMemoryProperties(
     const shared_ptr<PhysicalDevice> &physicalDevice,
     vk::ExternalMemoryHandleTypeFlagBits externalMemoryType,
@@ -118,7 +204,8 @@ shared_ptr<Image> Image::createOptimal(
     bool useMipMaps,
     bool storage,
     vk::ExternalMemoryHandleTypeFlags exportMemoryTypes,
-    uint32_t heap)
+    uint32_t heap,
+    bool dedicatedMemory)
 {
     auto image = make_shared<Image>(
         device,
@@ -132,7 +219,7 @@ shared_ptr<Image> Image::createOptimal(
         false,
         exportMemoryTypes
     );
-    image->init(MemoryPropertyPreset::PreferNoHostAccess, heap);
+    image->init(MemoryPropertyPreset::PreferNoHostAccess, heap, nullptr, dedicatedMemory);
     return image;
 }
 shared_ptr<Image> Image::createLinear(
@@ -144,7 +231,8 @@ shared_ptr<Image> Image::createLinear(
     bool useMipMaps,
     bool storage,
     vk::ExternalMemoryHandleTypeFlags exportMemoryTypes,
-    uint32_t heap)
+    uint32_t heap,
+    bool dedicatedMemory)
 {
     auto image = make_shared<Image>(
         device,
@@ -158,7 +246,7 @@ shared_ptr<Image> Image::createLinear(
         false,
         exportMemoryTypes
     );
-    image->init(memoryPropertyPreset, heap);
+    image->init(memoryPropertyPreset, heap, nullptr, dedicatedMemory);
     return image;
 }
 
@@ -269,7 +357,8 @@ Image::~Image()
 void Image::init(
     MemoryPropertyPreset memoryPropertyPreset,
     uint32_t heap,
-    ImageCreateInfoCallback imageCreateInfoCallback)
+    ImageCreateInfoCallback imageCreateInfoCallback,
+    bool dedicatedMemory)
 {
     if (m_useMipMaps)
     {
@@ -408,7 +497,11 @@ void Image::init(
         ;
         imageCreateInfo.usage = imageUsageFlags;
         imageCreateInfo.initialLayout = vk::ImageLayout::eUndefined;
-        if (enabledQueues.size() > 1)
+        if (enabledQueues.size() > 1 && m_device->isExclusiveSharing())
+        {
+            m_exclusiveSharing = true;
+        }
+        else if (enabledQueues.size() > 1)
         {
             imageCreateInfo.sharingMode = vk::SharingMode::eConcurrent;
             imageCreateInfo.queueFamilyIndexCount = enabledQueues.size();
@@ -428,11 +521,12 @@ void Image::init(
         m_images[i] = m_device->createImage(imageCreateInfo, nullptr, dld());
     }
 
-    allocateAndBindMemory(memoryPropertyPreset, heap);
+    allocateAndBindMemory(memoryPropertyPreset, heap, dedicatedMemory);
 }
-void Image::allocateAndBindMemory(MemoryPropertyPreset memoryPropertyPreset, uint32_t heap)
+void Image::allocateAndBindMemory(MemoryPropertyPreset memoryPropertyPreset, uint32_t heap, bool dedicatedMemory)
 {
     vector<vk::DeviceSize> memoryOffsets(m_numPlanes);
+    bool dedicatedAllocation = false;
 
     if (m_linear)
         fetchSubresourceLayouts();
@@ -449,15 +543,29 @@ void Image::allocateAndBindMemory(MemoryPropertyPreset memoryPropertyPreset, uin
         vk::MemoryRequirements2 memoryRequirements2;
         auto &memoryRequirements = memoryRequirements2.memoryRequirements;
 
-        if (m_ycbcr)
-        {
-            vk::ImagePlaneMemoryRequirementsInfo imagePlaneMemReqInfo;
-            imagePlaneMemReqInfo.planeAspect = getImageAspectFlagBits(i);
+        vk::ImagePlaneMemoryRequirementsInfo imagePlaneMemReqInfo;
+        imagePlaneMemReqInfo.planeAspect = getImageAspectFlagBits(i);
 
-            vk::ImageMemoryRequirementsInfo2 imageMemoryRequirementsInfo2;
-            imageMemoryRequirementsInfo2.image = m_images[0];
+        vk::ImageMemoryRequirementsInfo2 imageMemoryRequirementsInfo2;
+        imageMemoryRequirementsInfo2.image = m_images[m_ycbcr ? 0 : i];
+        if (m_ycbcr)
             imageMemoryRequirementsInfo2.pNext = &imagePlaneMemReqInfo;
 
+        if (m_device->hasDedicatedAllocation() && !m_externalImport)
+        {
+            vk::MemoryDedicatedRequirements memoryDedicatedRequirements;
+            tie(memoryRequirements2, memoryDedicatedRequirements) = m_device->getImageMemoryRequirements2<
+                vk::MemoryRequirements2,
+                vk::MemoryDedicatedRequirements
+            >(imageMemoryRequirementsInfo2, dld()).get<
+                vk::MemoryRequirements2,
+                vk::MemoryDedicatedRequirements
+            >();
+            if (memoryDedicatedRequirements.requiresDedicatedAllocation || memoryDedicatedRequirements.prefersDedicatedAllocation)
+                dedicatedAllocation = true;
+        }
+        else if (m_ycbcr)
+        {
             memoryRequirements2 = m_device->getImageMemoryRequirements2KHR(imageMemoryRequirementsInfo2, dld());
         }
         else
@@ -558,7 +666,19 @@ void Image::allocateAndBindMemory(MemoryPropertyPreset memoryPropertyPreset, uin
             break;
     }
     memoryPropertyFlags.heap = heap;
-    allocateMemory(memoryPropertyFlags);
+    memoryPropertyFlags.dedicated = (dedicatedMemory || dedicatedAllocation);
+
+    // Dedicated allocation info can be used only if the memory is bound to a single non-disjoint image
+    vk::MemoryDedicatedAllocateInfo memoryDedicatedAllocateInfo;
+#ifdef QMVK_USE_IMAGE_BUFFER_VIEW
+    const bool useMemoryDedicatedAllocateInfo = (dedicatedAllocation && m_images.size() == 1 && !m_ycbcr && !m_uniqueBuffer);
+#else
+    const bool useMemoryDedicatedAllocateInfo = (dedicatedAllocation && m_images.size() == 1 && !m_ycbcr);
+#endif
+    if (useMemoryDedicatedAllocateInfo)
+        memoryDedicatedAllocateInfo.image = m_images[0];
+
+    allocateMemory(memoryPropertyFlags, useMemoryDedicatedAllocateInfo ? &memoryDedicatedAllocateInfo : nullptr, m_linear);
 
     if (m_ycbcr)
     {
@@ -570,14 +690,14 @@ void Image::allocateAndBindMemory(MemoryPropertyPreset memoryPropertyPreset, uin
 
             bindImageMemInfos[i].image = m_images[0];
             bindImageMemInfos[i].memory = deviceMemory();
-            bindImageMemInfos[i].memoryOffset = memoryOffsets[i];
+            bindImageMemInfos[i].memoryOffset = m_memoryOffset + memoryOffsets[i];
             bindImageMemInfos[i].pNext = &bindImagePlaneMemInfos[i];
         }
         m_device->bindImageMemory2KHR(bindImageMemInfos, dld());
     }
     else for (uint32_t i = 0; i < m_numImages; ++i)
     {
-        m_device->bindImageMemory(m_images[i], deviceMemory(), memoryOffsets[i], dld());
+        m_device->bindImageMemory(m_images[i], deviceMemory(), m_memoryOffset + memoryOffsets[i], dld());
     }
 }
 
@@ -655,8 +775,10 @@ shared_ptr<BufferView> Image::bufferView(uint32_t plane)
             vk::BufferUsageFlagBits::eUniformTexelBuffer | vk::BufferUsageFlagBits::eStorageTexelBuffer,
             deviceMemory(),
             m_memoryPropertyFlags,
-            &m_uniqueBuffer
+            &m_uniqueBuffer,
+            m_memoryOffset
         );
+        buffer->borrowAllocation(*this);
 
         m_bufferViews.reserve(m_numPlanes);
         for (uint32_t i = 0; i < m_numPlanes; ++i)
@@ -742,7 +864,7 @@ void *Image::map(uint32_t plane)
         if (m_externalImport || m_externalImage)
             throw vk::LogicError("Can't map externally imported memory or image");
 
-        m_mapped = m_device->mapMemory(deviceMemory(), 0, memorySize(), {}, dld());
+        m_mapped = mapDeviceMemory();
     }
 
     if (plane == ~0u)
@@ -755,7 +877,7 @@ void Image::unmap()
     if (!m_mapped)
         return;
 
-    m_device->unmapMemory(deviceMemory(), dld());
+    unmapDeviceMemory();
     m_mapped = nullptr;
 }
 
@@ -773,18 +895,20 @@ void Image::copyTo(
         throw vk::LogicError("Source image and destination image format missmatch");
 
     auto copyCommands = [&](vk::CommandBuffer commandBuffer) {
+        PipelineBarriers pipelineBarriers(m_device, vk::PipelineStageFlagBits2::eCopy);
         pipelineBarrier(
-            commandBuffer,
+            pipelineBarriers,
             vk::ImageLayout::eTransferSrcOptimal,
             vk::PipelineStageFlagBits::eTransfer,
             vk::AccessFlagBits::eTransferRead
         );
         dstImage->pipelineBarrier(
-            commandBuffer,
+            pipelineBarriers,
             vk::ImageLayout::eTransferDstOptimal,
             vk::PipelineStageFlagBits::eTransfer,
             vk::AccessFlagBits::eTransferWrite
         );
+        pipelineBarriers.record(commandBuffer);
 
         for (uint32_t i = 0; i < m_numPlanes; ++i)
         {
@@ -824,6 +948,123 @@ void Image::copyTo(
     }
 }
 
+void Image::copyFromBuffer(
+    const shared_ptr<Buffer> &srcBuffer,
+    vk::DeviceSize bufferOffset,
+    uint32_t plane,
+    uint32_t bufferRowLength,
+    const shared_ptr<CommandBuffer> &externalCommandBuffer)
+{
+    BufferCopy region;
+    region.plane = plane;
+    region.bufferOffset = bufferOffset;
+    region.bufferRowLength = bufferRowLength;
+    copyFromBuffer(srcBuffer, {region}, externalCommandBuffer);
+}
+void Image::copyFromBuffer(
+    const shared_ptr<Buffer> &srcBuffer,
+    const vector<BufferCopy> &regions,
+    const shared_ptr<CommandBuffer> &externalCommandBuffer)
+{
+    if (m_externalImport || m_externalImage)
+        throw vk::LogicError("Can't copy to externally imported memory or image");
+
+    if (!(srcBuffer->usage() & vk::BufferUsageFlagBits::eTransferSrc))
+        throw vk::LogicError("Source buffer is not flagged as transfer source");
+
+    const auto bufferImageCopies = getBufferImageCopies(regions, srcBuffer->size(), false);
+
+    auto copyCommands = [&](vk::CommandBuffer commandBuffer) {
+        PipelineBarriers pipelineBarriers(m_device, vk::PipelineStageFlagBits2::eCopy);
+        srcBuffer->pipelineBarrier(
+            pipelineBarriers,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::AccessFlagBits::eTransferRead
+        );
+        pipelineBarrier(
+            pipelineBarriers,
+            vk::ImageLayout::eTransferDstOptimal,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::AccessFlagBits::eTransferWrite
+        );
+        pipelineBarriers.record(commandBuffer);
+
+        for (uint32_t i = 0; i < regions.size(); ++i)
+        {
+            commandBuffer.copyBufferToImage(
+                *srcBuffer,
+                m_images[m_ycbcr ? 0 : regions[i].plane],
+                m_imageLayout,
+                1,
+                &bufferImageCopies[i],
+                dld()
+            );
+        }
+
+        maybeGenerateMipmaps(commandBuffer);
+    };
+
+    if (externalCommandBuffer)
+    {
+        externalCommandBuffer->storeData(srcBuffer);
+        externalCommandBuffer->storeData(shared_from_this());
+        copyCommands(*externalCommandBuffer);
+    }
+    else
+    {
+        internalCommandBuffer()->execute(copyCommands);
+    }
+}
+void Image::copyToBuffer(
+    const shared_ptr<Buffer> &dstBuffer,
+    const vector<BufferCopy> &regions,
+    const shared_ptr<CommandBuffer> &externalCommandBuffer)
+{
+    if (!(dstBuffer->usage() & vk::BufferUsageFlagBits::eTransferDst))
+        throw vk::LogicError("Destination buffer is not flagged as transfer destination");
+
+    const auto bufferImageCopies = getBufferImageCopies(regions, dstBuffer->size(), true);
+
+    auto copyCommands = [&](vk::CommandBuffer commandBuffer) {
+        PipelineBarriers pipelineBarriers(m_device, vk::PipelineStageFlagBits2::eCopy);
+        pipelineBarrier(
+            pipelineBarriers,
+            vk::ImageLayout::eTransferSrcOptimal,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::AccessFlagBits::eTransferRead
+        );
+        dstBuffer->pipelineBarrier(
+            pipelineBarriers,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::AccessFlagBits::eTransferWrite
+        );
+        pipelineBarriers.record(commandBuffer);
+
+        for (uint32_t i = 0; i < regions.size(); ++i)
+        {
+            commandBuffer.copyImageToBuffer(
+                m_images[m_ycbcr ? 0 : regions[i].plane],
+                m_imageLayout,
+                *dstBuffer,
+                1,
+                &bufferImageCopies[i],
+                dld()
+            );
+        }
+    };
+
+    if (externalCommandBuffer)
+    {
+        externalCommandBuffer->storeData(shared_from_this());
+        externalCommandBuffer->storeData(dstBuffer);
+        copyCommands(*externalCommandBuffer);
+    }
+    else
+    {
+        internalCommandBuffer()->execute(copyCommands);
+    }
+}
+
 void Image::maybeGenerateMipmaps(const shared_ptr<CommandBuffer> &commandBuffer)
 {
     if (maybeGenerateMipmaps(*commandBuffer))
@@ -847,6 +1088,8 @@ bool Image::maybeGenerateMipmaps(vk::CommandBuffer commandBuffer)
     if (!m_useMipMaps || m_mipLevels <= 1)
         return false;
 
+    acquireOwnership(commandBuffer);
+
     vk::ImageSubresourceRange imageSubresourceRange = getImageSubresourceRange(1);
 
     auto mipSizes = m_sizes;
@@ -855,13 +1098,15 @@ bool Image::maybeGenerateMipmaps(vk::CommandBuffer commandBuffer)
     vk::PipelineStageFlags stage = m_stage;
     vk::AccessFlags accessFlags = m_accessFlags;
 
+    PipelineBarriers pipelineBarriers(m_device, vk::PipelineStageFlagBits2::eBlit);
+
     m_mipLevelsGenerated = 1;
 
     for (uint32_t l = 1; l < m_mipLevels; ++l)
     {
         imageSubresourceRange.baseMipLevel = l - 1;
         pipelineBarrier(
-            commandBuffer,
+            pipelineBarriers,
             imageLayout,
             vk::ImageLayout::eTransferSrcOptimal,
             stage,
@@ -874,7 +1119,7 @@ bool Image::maybeGenerateMipmaps(vk::CommandBuffer commandBuffer)
 
         imageSubresourceRange.baseMipLevel = l;
         pipelineBarrier(
-            commandBuffer,
+            pipelineBarriers,
             m_imageLayout,
             vk::ImageLayout::eTransferDstOptimal,
             m_stage,
@@ -885,6 +1130,8 @@ bool Image::maybeGenerateMipmaps(vk::CommandBuffer commandBuffer)
             false
         );
 
+        pipelineBarriers.record(commandBuffer);
+
         imageLayout = vk::ImageLayout::eTransferDstOptimal;
         stage = vk::PipelineStageFlagBits::eTransfer;
         accessFlags = vk::AccessFlagBits::eTransferWrite;
@@ -932,7 +1179,7 @@ bool Image::maybeGenerateMipmaps(vk::CommandBuffer commandBuffer)
 
     imageSubresourceRange.baseMipLevel = m_mipLevels - 1;
     pipelineBarrier(
-        commandBuffer,
+        pipelineBarriers,
         imageLayout,
         vk::ImageLayout::eTransferSrcOptimal,
         stage,
@@ -942,6 +1189,7 @@ bool Image::maybeGenerateMipmaps(vk::CommandBuffer commandBuffer)
         imageSubresourceRange,
         true
     );
+    pipelineBarriers.record(commandBuffer);
 
     return true;
 }
@@ -964,12 +1212,146 @@ vk::ImageSubresourceRange Image::getImageSubresourceRange(uint32_t mipLevels, ui
     return imageSubresourceRange;
 }
 
+vector<vk::BufferImageCopy> Image::getBufferImageCopies(
+    const vector<BufferCopy> &regions,
+    vk::DeviceSize bufferSize,
+    bool toBuffer) const
+{
+    vector<vk::BufferImageCopy> bufferImageCopies;
+    bufferImageCopies.reserve(regions.size());
+    for (auto &&region : regions)
+    {
+        if (region.plane >= m_numPlanes)
+            throw vk::LogicError("Invalid image plane");
+
+        const auto &planeSize = m_sizes[region.plane];
+        if (region.imageOffset.x < 0 || region.imageOffset.y < 0 ||
+            static_cast<uint32_t>(region.imageOffset.x) >= planeSize.width ||
+            static_cast<uint32_t>(region.imageOffset.y) >= planeSize.height)
+        {
+            throw vk::LogicError("Image offset is out of the plane");
+        }
+
+        vk::Extent2D imageExtent = region.imageExtent;
+        if (imageExtent.width == 0 || imageExtent.height == 0)
+        {
+            imageExtent.width = planeSize.width - region.imageOffset.x;
+            imageExtent.height = planeSize.height - region.imageOffset.y;
+        }
+        else if (region.imageOffset.x + imageExtent.width > planeSize.width || region.imageOffset.y + imageExtent.height > planeSize.height)
+        {
+            throw vk::LogicError("Image region exceeds the plane size");
+        }
+
+        if (region.bufferRowLength != 0 && region.bufferRowLength < imageExtent.width)
+            throw vk::LogicError("Buffer row length is smaller than the region width");
+        if (region.bufferImageHeight != 0 && region.bufferImageHeight < imageExtent.height)
+            throw vk::LogicError("Buffer image height is smaller than the region height");
+
+        if (const auto texelSize = getTexelSize(m_formats[region.plane]))
+        {
+            if (region.bufferOffset % texelSize != 0)
+                throw vk::LogicError("Buffer offset is not a multiple of the texel size");
+
+            // "bufferImageHeight" doesn't affect addressing of a single layer
+            const vk::DeviceSize rowLength = region.bufferRowLength ? region.bufferRowLength : imageExtent.width;
+            const vk::DeviceSize footprint = ((imageExtent.height - 1) * rowLength + imageExtent.width) * texelSize;
+            if (region.bufferOffset > bufferSize || footprint > bufferSize - region.bufferOffset)
+                throw vk::LogicError(toBuffer ? "Destination buffer overflow" : "Source buffer overflow");
+        }
+
+        vk::BufferImageCopy bufferImageCopy;
+        bufferImageCopy.bufferOffset = region.bufferOffset;
+        bufferImageCopy.bufferRowLength = region.bufferRowLength;
+        bufferImageCopy.bufferImageHeight = region.bufferImageHeight;
+        bufferImageCopy.imageSubresource.aspectMask = getImageAspectFlagBits(m_ycbcr ? region.plane : ~0u);
+        bufferImageCopy.imageSubresource.layerCount = 1;
+        bufferImageCopy.imageOffset = vk::Offset3D(region.imageOffset.x, region.imageOffset.y, 0);
+        bufferImageCopy.imageExtent = vk::Extent3D(imageExtent, 1);
+        bufferImageCopies.push_back(bufferImageCopy);
+    }
+    return bufferImageCopies;
+}
+
 inline bool Image::mustExecPipelineBarrier(
     vk::ImageLayout newLayout,
     vk::PipelineStageFlags dstStage,
-    vk::AccessFlags dstAccessFlags)
+    vk::AccessFlags dstAccessFlags,
+    vk::PipelineStageFlags2 transferStage)
+{
+    if (m_imageLayout != newLayout || m_stage != dstStage || m_accessFlags != dstAccessFlags)
+        return true;
+    if ((dstStage & vk::PipelineStageFlagBits::eTransfer) && (m_transferStage & transferStage) != transferStage)
+        return true;
+    return false;
+}
+
+void Image::releaseOwnership(
+    vk::CommandBuffer commandBuffer,
+    uint32_t srcQueueFamilyIndex,
+    uint32_t dstQueueFamilyIndex)
+{
+    // Nothing to preserve in undefined layout
+    if (!m_exclusiveSharing || srcQueueFamilyIndex == dstQueueFamilyIndex || m_imageLayout == vk::ImageLayout::eUndefined)
+        return;
+
+    // Layout is not changed, so the acquire barrier doesn't have to know the next layout
+    PipelineBarriers pipelineBarriers(m_device);
+    for (auto &&image : m_images)
+    {
+        pipelineBarriers.addImageBarrier(
+            m_stage,
+            vk::PipelineStageFlagBits::eBottomOfPipe,
+            vk::ImageMemoryBarrier(
+                m_accessFlags,
+                vk::AccessFlags(),
+                m_imageLayout,
+                m_imageLayout,
+                srcQueueFamilyIndex,
+                dstQueueFamilyIndex,
+                image,
+                getImageSubresourceRange()
+            )
+        );
+    }
+    pipelineBarriers.record(commandBuffer);
+
+    m_ownershipTransfer = {srcQueueFamilyIndex, dstQueueFamilyIndex};
+    m_stage = vk::PipelineStageFlagBits::eTopOfPipe;
+    m_accessFlags = vk::AccessFlags();
+}
+void Image::acquireOwnership(vk::CommandBuffer commandBuffer)
 {
-    return (m_imageLayout != newLayout || m_stage != dstStage || m_accessFlags != dstAccessFlags);
+    PipelineBarriers pipelineBarriers(m_device);
+    acquireOwnership(pipelineBarriers.ownershipBarriers());
+    pipelineBarriers.record(commandBuffer);
+}
+void Image::acquireOwnership(PipelineBarriers &pipelineBarriers)
+{
+    if (!hasPendingOwnershipTransfer())
+        return;
+
+    for (auto &&image : m_images)
+    {
+        pipelineBarriers.addImageBarrier(
+            vk::PipelineStageFlagBits::eTopOfPipe,
+            vk::PipelineStageFlagBits::eAllCommands,
+            vk::ImageMemoryBarrier(
+                vk::AccessFlags(),
+                vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+                m_imageLayout,
+                m_imageLayout,
+                m_ownershipTransfer.first,
+                m_ownershipTransfer.second,
+                image,
+                getImageSubresourceRange()
+            )
+        );
+    }
+
+    m_ownershipTransfer = {VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED};
+    m_stage = vk::PipelineStageFlagBits::eAllCommands;
+    m_accessFlags = vk::AccessFlags();
 }
 
 void Image::pipelineBarrier(
@@ -978,8 +1360,20 @@ void Image::pipelineBarrier(
     vk::PipelineStageFlags dstStage,
     vk::AccessFlags dstAccessFlags)
 {
+    PipelineBarriers pipelineBarriers(m_device);
+    pipelineBarrier(pipelineBarriers, dstImageLayout, dstStage, dstAccessFlags);
+    pipelineBarriers.record(commandBuffer);
+}
+void Image::pipelineBarrier(
+    PipelineBarriers &pipelineBarriers,
+    vk::ImageLayout dstImageLayout,
+    vk::PipelineStageFlags dstStage,
+    vk::AccessFlags dstAccessFlags)
+{
+    acquireOwnership(pipelineBarriers.ownershipBarriers());
+
     pipelineBarrier(
-        commandBuffer,
+        pipelineBarriers,
         m_imageLayout,
         dstImageLayout,
         m_stage,
@@ -991,7 +1385,7 @@ void Image::pipelineBarrier(
     );
 }
 void Image::pipelineBarrier(
-    vk::CommandBuffer commandBuffer,
+    PipelineBarriers &pipelineBarriers,
     vk::ImageLayout srcImageLayout,
     vk::ImageLayout dstImageLayout,
     vk::PipelineStageFlags srcStage,
@@ -1001,32 +1395,24 @@ void Image::pipelineBarrier(
     const vk::ImageSubresourceRange &imageSubresourceRange,
     bool updateVariables)
 {
-    if (!mustExecPipelineBarrier(dstImageLayout, dstStage, dstAccessFlags))
+    if (!mustExecPipelineBarrier(dstImageLayout, dstStage, dstAccessFlags, pipelineBarriers.transferStage()))
         return;
 
     for (auto &&image : m_images)
     {
-        vk::ImageMemoryBarrier barrier(
-            srcAccessFlags,
-            dstAccessFlags,
-            srcImageLayout,
-            dstImageLayout,
-            VK_QUEUE_FAMILY_IGNORED,
-            VK_QUEUE_FAMILY_IGNORED,
-            image,
-            imageSubresourceRange
-        );
-        commandBuffer.pipelineBarrier(
+        pipelineBarriers.addImageBarrier(
             srcStage,
             dstStage,
-            vk::DependencyFlags(),
-            0,
-            nullptr,
-            0,
-            nullptr,
-            1,
-            &barrier,
-            dld()
+            vk::ImageMemoryBarrier(
+                srcAccessFlags,
+                dstAccessFlags,
+                srcImageLayout,
+                dstImageLayout,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                image,
+                imageSubresourceRange
+            )
         );
     }
 
@@ -1034,6 +1420,7 @@ void Image::pipelineBarrier(
     {
         m_imageLayout = dstImageLayout;
         m_stage = dstStage;
+        m_transferStage = pipelineBarriers.transferStage();
         m_accessFlags = dstAccessFlags;
     }
 }
@@ -16,6 +16,8 @@ namespace QmVk {
 
 using namespace std;
 
+class PipelineBarriers;
+class Buffer;
 #ifdef QMVK_USE_IMAGE_BUFFER_VIEW
 class BufferView;
 #endif
@@ -36,6 +38,19 @@ public:
 
     using ImageCreateInfoCallback = function<void(uint32_t plane, vk::ImageCreateInfo &imageCreateInfo)>;
 
+    // Region of a single plane (the first mip level), YCbCr planes use their plane aspect.
+    // "bufferRowLength" and "bufferImageHeight" are in texels (0 - tightly packed),
+    // empty "imageExtent" means the rest of the plane from "imageOffset".
+    struct BufferCopy
+    {
+        uint32_t plane = 0;
+        vk::DeviceSize bufferOffset = 0;
+        uint32_t bufferRowLength = 0;
+        uint32_t bufferImageHeight = 0;
+        vk::Offset2D imageOffset;
+        vk::Extent2D imageExtent;
+    };
+
 public:
     static bool checkImageFormat(
         const shared_ptr<PhysicalDevice> &physicalDevice,
@@ -48,6 +63,9 @@ public:
 
     static uint32_t getNumPlanes(vk::Format format);
 
+    // Size in bytes of a texel of an uncompressed single plane format, zero if unknown
+    static uint32_t getTexelSize(vk::Format format);
+
     static vk::ExternalMemoryProperties getExternalMemoryProperties(
         const shared_ptr<PhysicalDevice> &physicalDevice,
         vk::ExternalMemoryHandleTypeFlagBits externalMemoryType,
@@ -63,7 +81,8 @@ public:
         bool useMipMaps = false,
         bool storage = false,
         vk::ExternalMemoryHandleTypeFlags exportMemoryTypes = {},
-        uint32_t heap = ~0u
+        uint32_t heap = ~0u,
+        bool dedicatedMemory = false
     );
     static shared_ptr<Image> createLinear(
         const shared_ptr<Device> &device,
@@ -74,7 +93,8 @@ public:
         bool useMipMaps = false,
         bool storage = false,
         vk::ExternalMemoryHandleTypeFlags exportMemoryTypes = {},
-        uint32_t heap = ~0u
+        uint32_t heap = ~0u,
+        bool dedicatedMemory = false
     );
 
     static shared_ptr<Image> createExternalImport(
@@ -114,9 +134,10 @@ private:
     void init(
         MemoryPropertyPreset memoryPropertyPreset,
         uint32_t heap = ~0u,
-        ImageCreateInfoCallback imageCreateInfoCallback = nullptr
+        ImageCreateInfoCallback imageCreateInfoCallback = nullptr,
+        bool dedicatedMemory = false
     );
-    void allocateAndBindMemory(MemoryPropertyPreset memoryPropertyPreset, uint32_t heap);
+    void allocateAndBindMemory(MemoryPropertyPreset memoryPropertyPreset, uint32_t heap, bool dedicatedMemory);
 
     void finishImport(const vector<vk::DeviceSize> &offsets, vk::DeviceSize globalOffset = 0u);
 
@@ -189,8 +210,34 @@ public:
         const shared_ptr<CommandBuffer> &externalCommandBuffer = nullptr
     );
 
+    // Copies the whole plane from "srcBuffer", "bufferRowLength" is in texels (0 - tightly packed)
+    void copyFromBuffer(
+        const shared_ptr<Buffer> &srcBuffer,
+        vk::DeviceSize bufferOffset,
+        uint32_t plane = 0,
+        uint32_t bufferRowLength = 0,
+        const shared_ptr<CommandBuffer> &externalCommandBuffer = nullptr
+    );
+    void copyFromBuffer(
+        const shared_ptr<Buffer> &srcBuffer,
+        const vector<BufferCopy> &regions,
+        const shared_ptr<CommandBuffer> &externalCommandBuffer = nullptr
+    );
+    void copyToBuffer(
+        const shared_ptr<Buffer> &dstBuffer,
+        const vector<BufferCopy> &regions,
+        const shared_ptr<CommandBuffer> &externalCommandBuffer = nullptr
+    );
+
     void maybeGenerateMipmaps(const shared_ptr<CommandBuffer> &commandBuffer);
 
+    void releaseOwnership(
+        vk::CommandBuffer commandBuffer,
+        uint32_t srcQueueFamilyIndex,
+        uint32_t dstQueueFamilyIndex
+    ) override;
+    void acquireOwnership(vk::CommandBuffer commandBuffer) override;
+
     // Modify only on external image
     inline vk::ImageLayout &imageLayout();
     inline vk::PipelineStageFlags &stage();
@@ -205,10 +252,19 @@ private:
 
     vk::ImageSubresourceRange getImageSubresourceRange(uint32_t mipLevels = ~0u, uint32_t plane = ~0u) const;
 
+    vector<vk::BufferImageCopy> getBufferImageCopies(
+        const vector<BufferCopy> &regions,
+        vk::DeviceSize bufferSize,
+        bool toBuffer
+    ) const;
+
+    void acquireOwnership(PipelineBarriers &pipelineBarriers);
+
     inline bool mustExecPipelineBarrier(
         vk::ImageLayout dstImageLayout,
         vk::PipelineStageFlags dstStage,
-        vk::AccessFlags dstAccessFlags
+        vk::AccessFlags dstAccessFlags,
+        vk::PipelineStageFlags2 transferStage
     );
 
     void pipelineBarrier(
@@ -218,7 +274,13 @@ private:
         vk::AccessFlags dstAccessFlags
     );
     void pipelineBarrier(
-        vk::CommandBuffer commandBuffer,
+        PipelineBarriers &pipelineBarriers,
+        vk::ImageLayout newLayout,
+        vk::PipelineStageFlags dstStage,
+        vk::AccessFlags dstAccessFlags
+    );
+    void pipelineBarrier(
+        PipelineBarriers &pipelineBarriers,
         vk::ImageLayout srcImageLayout,
         vk::ImageLayout dstImageLayout,
         vk::PipelineStageFlags srcStage,
@@ -270,6 +332,7 @@ private:
 
     vk::ImageLayout m_imageLayout = vk::ImageLayout::eUndefined;
     vk::PipelineStageFlags m_stage = vk::PipelineStageFlagBits::eTopOfPipe;
+    vk::PipelineStageFlags2 m_transferStage = vk::PipelineStageFlagBits2::eAllTransfer; // Transfer stages waited for by the last barrier
     vk::AccessFlags m_accessFlags;
 };
 
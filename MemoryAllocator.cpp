@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "MemoryAllocator.hpp"
+#include "MemoryObjectBase.hpp"
+#include "PhysicalDevice.hpp"
+#include "Device.hpp"
+
+namespace QmVk {
+
+static constexpr vk::DeviceSize g_maxBlockSize = 64 * 1024 * 1024;
+static constexpr vk::DeviceSize g_minBlockSize = 1 * 1024 * 1024;
+
+struct MemoryAllocator::Block
+{
+    vk::DeviceMemory deviceMemory;
+    vk::DeviceSize size = 0;
+    vk::DeviceSize used = 0;
+    std::map<vk::DeviceSize, vk::DeviceSize> freeRanges; // {offset, size}
+    void *mapped = nullptr;
+    uint32_t poolKey = 0;
+};
+
+static inline uint32_t getPoolKey(uint32_t memoryTypeIndex, bool linear)
+{
+    // Linear and optimal resources never share a block, so "bufferImageGranularity" is always satisfied
+    return (memoryTypeIndex << 1) | (linear ? 1u : 0u);
+}
+
+MemoryAllocator::MemoryAllocator(Device &device)
+    : m_device(device)
+{
+    const auto physicalDevice = m_device.physicalDevice();
+    const auto &memoryProperties = physicalDevice->memoryProperties();
+    const auto nonCoherentAtomSize = physicalDevice->limits().nonCoherentAtomSize;
+
+    m_blockSizes.resize(memoryProperties.memoryTypeCount);
+    m_atomSizes.resize(memoryProperties.memoryTypeCount, 1);
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        const auto &memoryType = memoryProperties.memoryTypes[i];
+        const auto heapSize = memoryProperties.memoryHeaps[memoryType.heapIndex].size;
+
+        m_blockSizes[i] = max(g_minBlockSize, min(g_maxBlockSize, heapSize / 8));
+
+        const auto hostFlags = memoryType.propertyFlags & (vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        if (hostFlags == vk::MemoryPropertyFlagBits::eHostVisible && nonCoherentAtomSize > 1)
+        {
+            // Keep non-coherent allocations flushable without touching the neighbours
+            m_atomSizes[i] = nonCoherentAtomSize;
+        }
+    }
+}
+MemoryAllocator::~MemoryAllocator()
+{
+    for (auto &&pool : m_blocks)
+    {
+        for (auto &&block : pool.second)
+            destroyBlock(block.get());
+    }
+}
+
+MemoryAllocator::Allocation MemoryAllocator::allocate(
+    const vk::MemoryRequirements &memoryRequirements,
+    uint32_t memoryTypeIndex,
+    bool linear)
+{
+    Allocation allocation;
+
+    if (memoryTypeIndex >= m_blockSizes.size())
+        return allocation;
+
+    const auto blockSize = m_blockSizes[memoryTypeIndex];
+    const auto atomSize = m_atomSizes[memoryTypeIndex];
+    const auto alignment = max<vk::DeviceSize>(memoryRequirements.alignment, atomSize);
+    const auto size = MemoryObjectBase::aligned(memoryRequirements.size, atomSize);
+
+    if (size > blockSize / 2)
+        return allocation;
+
+    auto tryAllocate = [&](Block *block) {
+        auto &freeRanges = block->freeRanges;
+        for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+        {
+            const auto rangeOffset = it->first;
+            const auto rangeSize = it->second;
+
+            const auto offset = MemoryObjectBase::aligned(rangeOffset, alignment);
+            const auto padding = offset - rangeOffset;
+            if (padding + size > rangeSize)
+                continue;
+
+            freeRanges.erase(it);
+            if (padding > 0)
+                freeRanges.emplace(rangeOffset, padding);
+            if (const auto tail = rangeSize - padding - size; tail > 0)
+                freeRanges.emplace(offset + size, tail);
+            block->used += size;
+
+            allocation.m_block = block;
+            allocation.m_deviceMemory = block->deviceMemory;
+            allocation.m_offset = offset;
+            allocation.m_size = size;
+            return true;
+        }
+        return false;
+    };
+
+    lock_guard<mutex> locker(m_mutex);
+
+    auto &pool = m_blocks[getPoolKey(memoryTypeIndex, linear)];
+    for (auto &&block : pool)
+    {
+        if (block->size - block->used >= size && tryAllocate(block.get()))
+            return allocation;
+    }
+
+    Block *block = nullptr;
+    try
+    {
+        block = createBlock(memoryTypeIndex, linear, blockSize);
+    }
+    catch (const vk::OutOfDeviceMemoryError &)
+    {
+        // Not enough memory for a whole block, try with the smallest possible one
+        block = createBlock(memoryTypeIndex, linear, MemoryObjectBase::aligned(size, alignment));
+    }
+    tryAllocate(block);
+
+    return allocation;
+}
+void MemoryAllocator::free(Allocation &allocation)
+{
+    if (!allocation)
+        return;
+
+    lock_guard<mutex> locker(m_mutex);
+
+    auto block = allocation.m_block;
+    auto &freeRanges = block->freeRanges;
+
+    auto offset = allocation.m_offset;
+    auto size = allocation.m_size;
+
+    auto next = freeRanges.lower_bound(offset);
+    if (next != freeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            freeRanges.erase(prev);
+        }
+    }
+    freeRanges.emplace(offset, size);
+
+    block->used -= allocation.m_size;
+
+    allocation = Allocation();
+
+    if (block->used == 0)
+    {
+        // Keep at least one empty block per pool to avoid allocation churn
+        auto &pool = m_blocks[block->poolKey];
+        if (pool.size() > 1)
+        {
+            auto it = find_if(pool.begin(), pool.end(), [block](const unique_ptr<Block> &b) {
+                return (b.get() == block);
+            });
+            destroyBlock(block);
+            pool.erase(it);
+        }
+    }
+}
+
+void *MemoryAllocator::map(const Allocation &allocation)
+{
+    if (!allocation)
+        return nullptr;
+
+    lock_guard<mutex> locker(m_mutex);
+
+    auto block = allocation.m_block;
+    if (!block->mapped)
+        block->mapped = m_device.mapMemory(block->deviceMemory, 0, VK_WHOLE_SIZE, {}, m_device.dld());
+
+    return reinterpret_cast<uint8_t *>(block->mapped) + allocation.m_offset;
+}
+
+MemoryAllocator::Block *MemoryAllocator::createBlock(uint32_t memoryTypeIndex, bool linear, vk::DeviceSize size)
+{
+    vk::MemoryAllocateInfo allocateInfo;
+    allocateInfo.allocationSize = size;
+    allocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+    auto block = make_unique<Block>();
+    block->deviceMemory = m_device.allocateMemory(allocateInfo, nullptr, m_device.dld());
+    block->size = size;
+    block->freeRanges.emplace(0, size);
+    block->poolKey = getPoolKey(memoryTypeIndex, linear);
+
+    auto &pool = m_blocks[block->poolKey];
+    pool.push_back(move(block));
+    return pool.back().get();
+}
+void MemoryAllocator::destroyBlock(Block *block)
+{
+    if (block->mapped)
+        m_device.unmapMemory(block->deviceMemory, m_device.dld());
+    m_device.freeMemory(block->deviceMemory, nullptr, m_device.dld());
+}
+
+}
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <map>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+
+class QMVK_EXPORT MemoryAllocator
+{
+    MemoryAllocator(const MemoryAllocator &) = delete;
+
+    struct Block;
+
+public:
+    class Allocation
+    {
+        friend class MemoryAllocator;
+
+    public:
+        inline vk::DeviceMemory deviceMemory() const;
+        inline vk::DeviceSize offset() const;
+        inline vk::DeviceSize size() const;
+
+        inline explicit operator bool() const;
+
+    private:
+        Block *m_block = nullptr;
+        vk::DeviceMemory m_deviceMemory;
+        vk::DeviceSize m_offset = 0;
+        vk::DeviceSize m_size = 0;
+    };
+
+public:
+    MemoryAllocator(Device &device);
+    ~MemoryAllocator();
+
+public:
+    inline vk::DeviceSize blockSize(uint32_t memoryTypeIndex) const;
+
+    // Returns empty allocation if the requested size should have dedicated memory
+    Allocation allocate(
+        const vk::MemoryRequirements &memoryRequirements,
+        uint32_t memoryTypeIndex,
+        bool linear
+    );
+    void free(Allocation &allocation);
+
+    // Memory block stays mapped until it's freed
+    void *map(const Allocation &allocation);
+
+private:
+    Block *createBlock(uint32_t memoryTypeIndex, bool linear, vk::DeviceSize size);
+    void destroyBlock(Block *block);
+
+private:
+    Device &m_device;
+
+    vector<vk::DeviceSize> m_blockSizes;
+    vector<vk::DeviceSize> m_atomSizes;
+
+    mutex m_mutex;
+    unordered_map<uint32_t, vector<unique_ptr<Block>>> m_blocks;
+};
+
+/* Inline implementation */
+
+vk::DeviceMemory MemoryAllocator::Allocation::deviceMemory() const
+{
+    return m_deviceMemory;
+}
+vk::DeviceSize MemoryAllocator::Allocation::offset() const
+{
+    return m_offset;
+}
+vk::DeviceSize MemoryAllocator::Allocation::size() const
+{
+    return m_size;
+}
+
+MemoryAllocator::Allocation::operator bool() const
+{
+    return (m_block != nullptr);
+}
+
+vk::DeviceSize MemoryAllocator::blockSize(uint32_t memoryTypeIndex) const
+{
+    return m_blockSizes[memoryTypeIndex];
+}
+
+}
@@ -22,6 +22,12 @@ MemoryObject::MemoryObject(
 MemoryObject::~MemoryObject()
 {
     m_customData.reset();
+    if (m_allocation)
+    {
+        if (!m_allocationBorrowed)
+            m_device->memoryAllocator()->free(m_allocation);
+        m_deviceMemory.clear();
+    }
     for (auto &&deviceMemory : m_deviceMemory)
         m_device->freeMemory(deviceMemory, nullptr, dld());
 }
@@ -97,8 +103,12 @@ void MemoryObject::importWin32Handle(
 
 void MemoryObject::allocateMemory(
     const MemoryPropertyFlags &userMemoryPropertyFlags,
-    void *allocateInfoPNext)
+    void *allocateInfoPNext,
+    bool linear)
 {
+    // Exported memory and custom allocations must own the whole "VkDeviceMemory"
+    const bool canSubAllocate = (!userMemoryPropertyFlags.dedicated && !m_exportMemoryTypes && !allocateInfoPNext);
+
     vk::ExportMemoryAllocateInfo exportMemoryAllocateInfo(m_exportMemoryTypes);
     if (m_exportMemoryTypes)
     {
@@ -110,13 +120,28 @@ void MemoryObject::allocateMemory(
     allocateInfo.allocationSize = m_memoryRequirements.size;
     allocateInfo.pNext = allocateInfoPNext;
 
-    auto allocateMemoryInternal = [this, &allocateInfo](const MemoryPropertyFlags &userMemoryPropertyFlags) {
+    auto allocateMemoryInternal = [this, canSubAllocate, linear, &allocateInfo](const MemoryPropertyFlags &userMemoryPropertyFlags) {
         tie(allocateInfo.memoryTypeIndex, m_memoryPropertyFlags) = m_physicalDevice->findMemoryType(
             userMemoryPropertyFlags,
             m_memoryRequirements.memoryTypeBits,
             userMemoryPropertyFlags.heap
         );
 
+        if (canSubAllocate)
+        {
+            m_allocation = m_device->memoryAllocator()->allocate(
+                m_memoryRequirements,
+                allocateInfo.memoryTypeIndex,
+                linear
+            );
+            if (m_allocation)
+            {
+                m_memoryOffset = m_allocation.offset();
+                m_deviceMemory.push_back(m_allocation.deviceMemory());
+                return;
+            }
+        }
+
         m_deviceMemory.push_back(m_device->allocateMemory(allocateInfo, nullptr, dld()));
     };
 
@@ -176,6 +201,25 @@ void MemoryObject::allocateMemory(
     }
 }
 
+void MemoryObject::borrowAllocation(const MemoryObject &memoryObject)
+{
+    m_allocation = memoryObject.m_allocation;
+    m_allocationBorrowed = true;
+}
+
+void *MemoryObject::mapDeviceMemory()
+{
+    if (m_allocation)
+        return m_device->memoryAllocator()->map(m_allocation);
+    return m_device->mapMemory(deviceMemory(), m_memoryOffset, memorySize(), {}, dld());
+}
+void MemoryObject::unmapDeviceMemory()
+{
+    // Sub-allocated memory block is persistently mapped
+    if (!m_allocation)
+        m_device->unmapMemory(deviceMemory(), dld());
+}
+
 shared_ptr<CommandBuffer> MemoryObject::internalCommandBuffer()
 {
     if (!m_internalCommandBuffer)
@@ -9,6 +9,7 @@
 #include "QmVkExport.hpp"
 
 #include "MemoryObjectBase.hpp"
+#include "MemoryAllocator.hpp"
 
 namespace QmVk {
 
@@ -49,9 +50,17 @@ protected:
 
     void allocateMemory(
         const MemoryPropertyFlags &userMemoryPropertyFlags,
-        void *allocateInfoPNext = nullptr
+        void *allocateInfoPNext = nullptr,
+        bool linear = true
     );
 
+    // Shares the sub-allocation of "memoryObject" without taking its ownership, so mapping goes
+    // through the memory allocator. Used for objects bound to memory of another object.
+    void borrowAllocation(const MemoryObject &memoryObject);
+
+    void *mapDeviceMemory();
+    void unmapDeviceMemory();
+
 protected:
     shared_ptr<CommandBuffer> internalCommandBuffer();
 
@@ -60,6 +69,9 @@ public:
     inline vk::DeviceMemory deviceMemory(uint32_t idx = 0) const;
 
     inline vk::DeviceSize memorySize() const;
+    inline vk::DeviceSize memoryOffset() const;
+
+    inline bool isSubAllocated() const;
 
     inline bool isDeviceLocal() const;
     inline bool isHostVisible() const;
@@ -68,6 +80,20 @@ public:
 
     inline auto exportMemoryTypes() const;
 
+    inline bool isExclusiveSharing() const;
+    inline bool hasPendingOwnershipTransfer() const;
+
+    // Records the release part of queue family ownership transfer on "srcQueueFamilyIndex" queue.
+    // The acquire part must be recorded on "dstQueueFamilyIndex" queue after the release is
+    // finished, it's done automatically by the next barrier of the object.
+    // Does nothing if the object isn't exclusive.
+    virtual void releaseOwnership(
+        vk::CommandBuffer commandBuffer,
+        uint32_t srcQueueFamilyIndex,
+        uint32_t dstQueueFamilyIndex
+    ) = 0;
+    virtual void acquireOwnership(vk::CommandBuffer commandBuffer) = 0;
+
     int exportMemoryFd(vk::ExternalMemoryHandleTypeFlagBits type);
 
 #ifdef VK_USE_PLATFORM_WIN32_KHR
@@ -83,8 +109,15 @@ protected:
     vk::MemoryPropertyFlags m_memoryPropertyFlags;
 
     vector<vk::DeviceMemory> m_deviceMemory;
+    vk::DeviceSize m_memoryOffset = 0;
+
+    bool m_exclusiveSharing = false;
+    pair<uint32_t, uint32_t> m_ownershipTransfer {VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED}; // {src, dst}
 
 private:
+    MemoryAllocator::Allocation m_allocation;
+    bool m_allocationBorrowed = false;
+
     shared_ptr<CommandBuffer> m_internalCommandBuffer;
 };
 
@@ -103,6 +136,15 @@ vk::DeviceSize MemoryObject::memorySize() const
 {
     return m_memoryRequirements.size;
 }
+vk::DeviceSize MemoryObject::memoryOffset() const
+{
+    return m_memoryOffset;
+}
+
+bool MemoryObject::isSubAllocated() const
+{
+    return static_cast<bool>(m_allocation);
+}
 
 bool MemoryObject::isDeviceLocal() const
 {
@@ -126,4 +168,13 @@ auto MemoryObject::exportMemoryTypes() const
     return m_exportMemoryTypes;
 }
 
+bool MemoryObject::isExclusiveSharing() const
+{
+    return m_exclusiveSharing;
+}
+bool MemoryObject::hasPendingOwnershipTransfer() const
+{
+    return (m_ownershipTransfer.first != m_ownershipTransfer.second);
+}
+
 }
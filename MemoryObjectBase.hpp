@@ -11,6 +11,7 @@
 #include <vulkan/vulkan.hpp>
 
 #include <memory>
+#include <atomic>
 
 namespace QmVk {
 
@@ -20,6 +21,8 @@ class Device;
 
 class QMVK_EXPORT MemoryObjectBase
 {
+    friend class CommandBuffer;
+
 public:
     template<typename T>
     static inline T aligned(const T value, const T alignment);
@@ -50,6 +53,9 @@ private:
 
 protected:
     unique_ptr<CustomData> m_customData;
+
+private:
+    atomic<uint64_t> m_storedDataEpoch {0};
 };
 
 /* Inline implementation */
@@ -7,6 +7,7 @@
 #include "MemoryObjectDescr.hpp"
 #include "Buffer.hpp"
 #include "BufferView.hpp"
+#include "PipelineBarriers.hpp"
 #ifndef QMVK_NO_GRAPHICS
 #   include "Image.hpp"
 #   include "Sampler.hpp"
@@ -107,7 +108,7 @@ MemoryObjectDescr::MemoryObjectDescr(
 {}
 
 void MemoryObjectDescr::prepareObject(
-    vk::CommandBuffer commandBuffer,
+    PipelineBarriers &pipelineBarriers,
     vk::PipelineStageFlags pipelineStageFlags) const
 {
     vk::AccessFlags accessFlag = {};
@@ -144,7 +145,7 @@ void MemoryObjectDescr::prepareObject(
                     : static_pointer_cast<Buffer>(object)
                 ;
                 buffer->pipelineBarrier(
-                    commandBuffer,
+                    pipelineBarriers,
                     pipelineStageFlags,
                     accessFlag
                 );
@@ -155,7 +156,7 @@ void MemoryObjectDescr::prepareObject(
 #ifndef QMVK_NO_GRAPHICS
                 auto image = static_pointer_cast<Image>(object);
                 image->pipelineBarrier(
-                    commandBuffer,
+                    pipelineBarriers,
                     descriptorInfos()[descriptorInfosIdx].descrImgInfo.imageLayout,
                     pipelineStageFlags,
                     accessFlag
@@ -172,6 +173,7 @@ void MemoryObjectDescr::prepareObject(
 }
 void MemoryObjectDescr::finalizeObject(
     vk::CommandBuffer commandBuffer,
+    PipelineBarriers &pipelineBarriers,
     bool genMipmapsOnWrite,
     bool resetPipelineStageFlags) const
 {
@@ -195,7 +197,7 @@ void MemoryObjectDescr::finalizeObject(
                         : static_pointer_cast<Buffer>(object)
                     ;
                     buffer->pipelineBarrier(
-                        commandBuffer,
+                        pipelineBarriers,
                         vk::PipelineStageFlagBits::eBottomOfPipe,
                         vk::AccessFlags()
                     );
@@ -208,12 +210,14 @@ void MemoryObjectDescr::finalizeObject(
                 auto image = static_pointer_cast<Image>(object);
                 if (genMipmapsOnWrite && m_access == Access::Write)
                 {
+                    // Mipmaps generation records its own barriers, so flush the pending ones first
+                    pipelineBarriers.record(commandBuffer);
                     image->maybeGenerateMipmaps(commandBuffer);
                 }
                 if (resetPipelineStageFlags)
                 {
                     image->pipelineBarrier(
-                        commandBuffer,
+                        pipelineBarriers,
                         image->imageLayout(),
                         vk::PipelineStageFlagBits::eBottomOfPipe,
                         vk::AccessFlags()
@@ -386,6 +390,33 @@ MemoryObjectDescr::DescriptorTypeInfos MemoryObjectDescr::getBufferViewDescripto
     return descriptorTypeInfos;
 }
 
+size_t MemoryObjectDescr::hash() const
+{
+    size_t seed = 0;
+    auto hashCombine = [&seed](auto value) {
+        seed ^= std::hash<decltype(value)>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+
+    hashCombine(static_cast<int>(m_type));
+    hashCombine(static_cast<int>(m_access));
+    for (auto &&objectWeak : m_objects)
+        hashCombine(objectWeak.lock().get());
+#ifndef QMVK_NO_GRAPHICS
+    hashCombine(m_sampler.get());
+    hashCombine(m_plane);
+#endif
+    if (m_type == Type::Buffer)
+    {
+        for (auto &&descriptorInfo : m_descriptorTypeInfos.second)
+        {
+            hashCombine(descriptorInfo.descrBuffInfo.offset);
+            hashCombine(descriptorInfo.descrBuffInfo.range);
+        }
+    }
+
+    return seed;
+}
+
 bool MemoryObjectDescr::operator ==(const MemoryObjectDescr &other) const
 {
     auto compareObjects = [](const vector<weak_ptr<MemoryObjectBase>> &a, const vector<weak_ptr<MemoryObjectBase>> &b) {
@@ -22,6 +22,7 @@ class BufferView;
 class Image;
 class Sampler;
 #endif
+class PipelineBarriers;
 
 class MemoryObjectDescr
 {
@@ -98,11 +99,12 @@ public:
 
 private:
     void prepareObject(
-        vk::CommandBuffer commandBuffer,
+        PipelineBarriers &pipelineBarriers,
         vk::PipelineStageFlags pipelineStageFlags
     ) const;
     void finalizeObject(
         vk::CommandBuffer commandBuffer,
+        PipelineBarriers &pipelineBarriers,
         bool genMipmapsOnWrite,
         bool resetPipelineStageFlags
     ) const;
@@ -115,6 +117,9 @@ private:
     DescriptorTypeInfos getBufferViewDescriptorTypeInfos() const;
 
 public:
+    // Hash of the same data as used in comparison
+    size_t hash() const;
+
     bool operator ==(const MemoryObjectDescr &other) const;
 
 private:
@@ -5,6 +5,7 @@
 */
 
 #include "MemoryObjectDescrs.hpp"
+#include "PipelineBarriers.hpp"
 
 #ifndef NDEBUG
 #   include <unordered_map>
@@ -63,6 +64,7 @@ void MemoryObjectDescrs::iterateMemoryObjects(const Callback &callback) const
 
 void MemoryObjectDescrs::prepareObjects(
     vk::CommandBuffer commandBuffer,
+    const shared_ptr<Device> &device,
     vk::PipelineStageFlags pipelineStageFlags) const
 {
 #ifndef NDEBUG
@@ -86,16 +88,29 @@ void MemoryObjectDescrs::prepareObjects(
         }
     }
 #endif
+    PipelineBarriers pipelineBarriers(device);
     for (auto &&memoryObjectDescr : *m_memoryObjects)
-        memoryObjectDescr.prepareObject(commandBuffer, pipelineStageFlags);
+        memoryObjectDescr.prepareObject(pipelineBarriers, pipelineStageFlags);
+    pipelineBarriers.record(commandBuffer);
 }
 void MemoryObjectDescrs::finalizeObjects(
     vk::CommandBuffer commandBuffer,
+    const shared_ptr<Device> &device,
     bool genMipmapsOnWrite,
     bool resetPipelineStageFlags) const
 {
+    PipelineBarriers pipelineBarriers(device);
     for (auto &&memoryObjectDescr : *m_memoryObjects)
-        memoryObjectDescr.finalizeObject(commandBuffer, genMipmapsOnWrite, resetPipelineStageFlags);
+        memoryObjectDescr.finalizeObject(commandBuffer, pipelineBarriers, genMipmapsOnWrite, resetPipelineStageFlags);
+    pipelineBarriers.record(commandBuffer);
+}
+
+size_t MemoryObjectDescrs::hash() const
+{
+    size_t seed = m_memoryObjects->size();
+    for (auto &&memoryObjectDescr : *m_memoryObjects)
+        seed ^= memoryObjectDescr.hash() + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
 }
 
 bool MemoryObjectDescrs::operator ==(const MemoryObjectDescrs &other) const
@@ -16,6 +16,8 @@ namespace QmVk {
 
 using namespace std;
 
+class Device;
+
 class QMVK_EXPORT MemoryObjectDescrs
 {
     friend class hash<MemoryObjectDescrs>;
@@ -40,15 +42,20 @@ public:
 private:
     void prepareObjects(
         vk::CommandBuffer commandBuffer,
+        const shared_ptr<Device> &device,
         vk::PipelineStageFlags pipelineStageFlags
     ) const;
     void finalizeObjects(
         vk::CommandBuffer commandBuffer,
+        const shared_ptr<Device> &device,
         bool genMipmapsOnWrite,
         bool resetPipelineStageFlags
     ) const;
 
 public:
+    // Content hash, consistent with the comparison
+    size_t hash() const;
+
     bool operator ==(const MemoryObjectDescrs &other) const;
 
 private:
@@ -65,7 +72,7 @@ class hash<QmVk::MemoryObjectDescrs>
 public:
     size_t operator ()(const QmVk::MemoryObjectDescrs &k) const
     {
-        return hash<decltype(k.m_memoryObjects)>{}(k.m_memoryObjects);
+        return k.hash();
     }
 };
 
@@ -32,6 +32,7 @@ public:
     vk::MemoryPropertyFlags optionalFallback;
     vk::MemoryPropertyFlags notWanted;
     uint32_t heap = ~0;
+    bool dedicated = false; // Don't sub-allocate from a shared memory block
 };
 
 /* Inline implementation */
@@ -76,6 +76,11 @@ void PhysicalDevice::init()
         m_properties = getProperties(dld());
     }
 
+    m_memoryProperties = getMemoryProperties(dld());
+#ifdef QMVK_APPLY_MEMORY_PROPERTIES_QUIRKS
+    applyMemoryPropertiesQuirks(m_memoryProperties);
+#endif
+
     vk::DeviceSize deviceLocalAndHostVisibleSize = 0;
     vk::DeviceSize deviceLocalSize = 0;
     for (auto &&heapInfo : getMemoryHeapsInfo())
@@ -133,7 +138,8 @@ void PhysicalDevice::init()
         m_queues[queueFamilyIndex] = {
             props.queueFlags,
             queueFamilyIndex,
-            props.queueCount
+            props.queueCount,
+            props.timestampValidBits,
         };
     }
 }
@@ -313,14 +319,48 @@ PhysicalDevice::MemoryType PhysicalDevice::findMemoryType(
     const MemoryPropertyFlags &memoryPropertyFlags,
     uint32_t memoryTypeBits,
     uint32_t heap) const
+{
+    // Don't distinguish bits of non-existing memory types
+    memoryTypeBits &= (1ull << m_memoryProperties.memoryTypeCount) - 1ull;
+
+    const MemoryTypeKey key {
+        memoryPropertyFlags.required,
+        memoryPropertyFlags.optional,
+        memoryPropertyFlags.optionalFallback,
+        memoryPropertyFlags.notWanted,
+        heap,
+        memoryTypeBits,
+    };
+
+    lock_guard<mutex> locker(m_memoryTypesMutex);
+
+    auto it = m_memoryTypes.find(key);
+    if (it != m_memoryTypes.end())
+        return it->second;
+
+    MemoryType memoryType;
+    if (!findMemoryTypeInternal(memoryPropertyFlags, memoryTypeBits, heap, memoryType))
+        throw vk::InitializationFailedError("Cannot find specified memory type");
+
+    m_memoryTypes.emplace(key, memoryType);
+    return memoryType;
+}
+PhysicalDevice::MemoryType PhysicalDevice::findMemoryType(
+    uint32_t memoryTypeBits) const
+{
+    return findMemoryType(MemoryPropertyFlags(), memoryTypeBits);
+}
+
+bool PhysicalDevice::findMemoryTypeInternal(
+    const MemoryPropertyFlags &memoryPropertyFlags,
+    uint32_t memoryTypeBits,
+    uint32_t heap,
+    MemoryType &memoryType) const
 {
     using MemoryTypeResult = pair<MemoryType, bool>;
     MemoryTypeResult result;
 
-    auto memoryProperties = getMemoryProperties(dld());
-#ifdef QMVK_APPLY_MEMORY_PROPERTIES_QUIRKS
-    applyMemoryPropertiesQuirks(memoryProperties);
-#endif
+    const auto &memoryProperties = m_memoryProperties;
     bool optionalFallbackFound = false;
     for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
     {
@@ -384,14 +424,10 @@ PhysicalDevice::MemoryType PhysicalDevice::findMemoryType(
     }
 
     if (!result.second)
-        throw vk::InitializationFailedError("Cannot find specified memory type");
+        return false;
 
-    return result.first;
-}
-PhysicalDevice::MemoryType PhysicalDevice::findMemoryType(
-    uint32_t memoryTypeBits) const
-{
-    return findMemoryType(MemoryPropertyFlags(), memoryTypeBits);
+    memoryType = result.first;
+    return true;
 }
 
 vector<pair<uint32_t, uint32_t>> PhysicalDevice::getQueuesFamily(
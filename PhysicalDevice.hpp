@@ -47,6 +47,7 @@ public:
         vk::QueueFlags flags;
         uint32_t familyIndex;
         uint32_t count;
+        uint32_t timestampValidBits;
     };
 
 public:
@@ -70,6 +71,8 @@ public:
 
     inline const auto &pciBusInfo() const;
 
+    inline const auto &memoryProperties() const;
+
     inline bool hasMemoryBudget() const;
     inline bool hasPciBusInfo() const;
 
@@ -127,6 +130,14 @@ public:
 
     const vk::FormatProperties &getFormatPropertiesCached(vk::Format fmt);
 
+private:
+    bool findMemoryTypeInternal(
+        const MemoryPropertyFlags &memoryPropertyFlags,
+        uint32_t memoryTypeBits,
+        uint32_t heap,
+        MemoryType &memoryType
+    ) const;
+
 private:
     const shared_ptr<AbstractInstance> m_instance;
     const vk::detail::DispatchLoaderDynamic &m_dld;
@@ -136,6 +147,8 @@ private:
     vk::PhysicalDeviceProperties2 m_properties;
     vk::PhysicalDevicePCIBusInfoPropertiesEXT m_pciBusInfo;
 
+    vk::PhysicalDeviceMemoryProperties m_memoryProperties;
+
     bool m_hasMemoryBudget = false;
     bool m_hasPciBusInfo = false;
 
@@ -145,6 +158,17 @@ private:
 
     map<uint32_t, QueueProps> m_queues;
 
+    using MemoryTypeKey = tuple<
+        vk::MemoryPropertyFlags, // required
+        vk::MemoryPropertyFlags, // optional
+        vk::MemoryPropertyFlags, // optionalFallback
+        vk::MemoryPropertyFlags, // notWanted
+        uint32_t, // heap
+        uint32_t // memoryTypeBits
+    >;
+    mutable mutex m_memoryTypesMutex;
+    mutable map<MemoryTypeKey, MemoryType> m_memoryTypes;
+
     mutex m_formatPropertiesMutex;
     unordered_map<vk::Format, vk::FormatProperties> m_formatProperties;
 };
@@ -183,6 +207,11 @@ const auto &PhysicalDevice::pciBusInfo() const
     return m_pciBusInfo;
 }
 
+const auto &PhysicalDevice::memoryProperties() const
+{
+    return m_memoryProperties;
+}
+
 bool PhysicalDevice::hasMemoryBudget() const
 {
     return m_hasMemoryBudget;
@@ -7,13 +7,17 @@
 #include "Pipeline.hpp"
 #include "PhysicalDevice.hpp"
 #include "Device.hpp"
+#include "PipelineObjectCache.hpp"
 #include "DescriptorPool.hpp"
 #include "DescriptorSet.hpp"
+#include "DescriptorHeap.hpp"
 #include "DescriptorInfo.hpp"
 #include "CommandBuffer.hpp"
 
 namespace QmVk {
 
+static constexpr size_t g_maxCachedDescriptorSets = 8;
+
 Pipeline::Pipeline(
     const shared_ptr<Device> &device,
     const vk::ShaderStageFlags pushConstantsShaderStageFlags,
@@ -70,6 +74,20 @@ vk::SpecializationInfo Pipeline::getSpecializationInfo(
     );
 }
 
+void Pipeline::setPipeline(
+    string &&key,
+    const function<vk::UniquePipeline()> &create)
+{
+    if (m_pipelineLayoutKey.empty())
+    {
+        m_pipeline = make_shared<vk::UniquePipeline>(create());
+        return;
+    }
+
+    key += m_pipelineLayoutKey;
+    m_pipeline = m_device->pipelineObjectCache()->pipeline(key, create);
+}
+
 void Pipeline::pushConstants(
     const shared_ptr<CommandBuffer> &commandBuffer)
 {
@@ -77,7 +95,7 @@ void Pipeline::pushConstants(
         return;
 
     commandBuffer->pushConstants(
-        *m_pipelineLayout,
+        **m_pipelineLayout,
         m_pushConstantsShaderStageFlags,
         0,
         m_pushConstants.size(),
@@ -89,8 +107,29 @@ void Pipeline::bindObjects(
     const shared_ptr<CommandBuffer> &commandBuffer,
     vk::PipelineBindPoint pipelineBindPoint)
 {
-    commandBuffer->bindPipeline(pipelineBindPoint, *m_pipeline, m_dld);
-    if (m_descriptorSet)
+    commandBuffer->bindPipeline(pipelineBindPoint, **m_pipeline, m_dld);
+    if (m_descriptorSetLayout->isPushDescriptor())
+    {
+        if (!m_descriptorSetLayout->isEmpty())
+        {
+            commandBuffer->storeData(
+                m_memoryObjects,
+                nullptr
+            );
+
+            const auto descriptorInfos = m_memoryObjects.fetchDescriptorInfos();
+            const auto writeDescriptorSets = m_descriptorSetLayout->getWriteDescriptorSets(descriptorInfos);
+            commandBuffer->pushDescriptorSetKHR(
+                pipelineBindPoint,
+                **m_pipelineLayout,
+                0,
+                static_cast<uint32_t>(writeDescriptorSets.size()),
+                writeDescriptorSets.data(),
+                m_dld
+            );
+        }
+    }
+    else if (m_descriptorSet)
     {
         commandBuffer->storeData(
             m_memoryObjects,
@@ -98,21 +137,56 @@ void Pipeline::bindObjects(
         );
         commandBuffer->bindDescriptorSets(
             pipelineBindPoint,
-            *m_pipelineLayout,
+            **m_pipelineLayout,
             0,
             {*m_descriptorSet},
             {},
             m_dld
         );
     }
+    if (m_descriptorHeap)
+    {
+        commandBuffer->bindDescriptorSets(
+            pipelineBindPoint,
+            **m_pipelineLayout,
+            1,
+            {m_descriptorHeap->descriptorSet()},
+            {},
+            m_dld
+        );
+    }
+}
+
+bool Pipeline::setPushDescriptors(bool pushDescriptors)
+{
+    if (pushDescriptors && !m_device->hasExtension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME))
+        return false;
+
+    m_pushDescriptors = pushDescriptors;
+    return true;
+}
+
+void Pipeline::setDescriptorHeap(const shared_ptr<DescriptorHeap> &descriptorHeap)
+{
+    if (m_descriptorHeap == descriptorHeap)
+        return;
+
+    m_descriptorHeap = descriptorHeap;
+    m_mustRecreate = true;
 }
 
 void Pipeline::createDescriptorSetFromPool(const shared_ptr<DescriptorPool> &descriptorPool)
 {
+    if (descriptorPool && m_pushDescriptors)
+        throw vk::LogicError("Can't use descriptor pool with push descriptors");
+
     m_descriptorSet.reset();
+    m_externalDescriptorSet = false;
+    m_descriptorSetCache.clear();
     if (descriptorPool)
     {
         m_descriptorSet = DescriptorSet::create(descriptorPool);
+        m_externalDescriptorSet = true;
         m_mustUpdateDescriptorInfos = true;
     }
 }
@@ -130,44 +204,89 @@ void Pipeline::prepare()
     const auto descriptorTypes = m_memoryObjects.fetchDescriptorTypes();
     bool descriptorSetLayoutFromDescriptorSet = false;
 
+    bool pushDescriptors = m_pushDescriptors;
+    if (pushDescriptors)
+    {
+        uint32_t descriptorsCount = 0;
+        for (auto &&descriptorType : descriptorTypes)
+            descriptorsCount += descriptorType.descriptorCount;
+        if (descriptorsCount > m_device->maxPushDescriptors())
+            pushDescriptors = false;
+    }
+
+    if (pushDescriptors && m_descriptorSet)
+    {
+        m_descriptorSet.reset();
+        m_externalDescriptorSet = false;
+        m_descriptorSetCache.clear();
+    }
+
     if (m_descriptorSet)
     {
-        auto descriptorSetLayout = m_descriptorSet->descriptorPool()->descriptorSetLayout();
+        auto descriptorSetLayout = m_descriptorSet->descriptorSetLayout();
         descriptorSetLayoutFromDescriptorSet = (descriptorSetLayout == m_descriptorSetLayout);
         if (descriptorSetLayout->descriptorTypes() != descriptorTypes)
         {
             if (descriptorSetLayoutFromDescriptorSet)
                 m_descriptorSetLayout.reset();
             m_descriptorSet.reset();
+            m_externalDescriptorSet = false;
         }
     }
 
     if (!descriptorSetLayoutFromDescriptorSet)
     {
-        if (m_descriptorSetLayout && m_descriptorSetLayout->descriptorTypes() != descriptorTypes)
+        if (m_descriptorSetLayout && (m_descriptorSetLayout->descriptorTypes() != descriptorTypes || m_descriptorSetLayout->isPushDescriptor() != pushDescriptors))
             m_descriptorSetLayout.reset();
     }
 
     if (!m_descriptorSetLayout)
     {
         m_descriptorSetLayout = m_descriptorSet
-            ? m_descriptorSet->descriptorPool()->descriptorSetLayout()
-            : DescriptorSetLayout::create(m_device, descriptorTypes)
+            ? m_descriptorSet->descriptorSetLayout()
+            : DescriptorSetLayout::create(m_device, descriptorTypes, pushDescriptors)
         ;
+        m_descriptorSetCache.clear();
         m_mustRecreate = true;
     }
 
-    if (!m_descriptorSetLayout->isEmpty())
+    if (!m_descriptorSetLayout->isEmpty() && !pushDescriptors)
     {
+        const bool useCache = (!m_externalDescriptorSet && (m_mustUpdateDescriptorInfos || !m_descriptorSet));
+        const size_t memoryObjectsHash = useCache ? m_memoryObjects.hash() : 0;
+        if (useCache)
+        {
+            auto it = find_if(m_descriptorSetCache.begin(), m_descriptorSetCache.end(), [&](const CachedDescriptorSet &cached) {
+                return (cached.hash == memoryObjectsHash && cached.memoryObjects == m_memoryObjects);
+            });
+            if (it != m_descriptorSetCache.end())
+            {
+                m_descriptorSetCache.splice(m_descriptorSetCache.begin(), m_descriptorSetCache, it);
+                m_descriptorSet = it->descriptorSet;
+                m_mustUpdateDescriptorInfos = false;
+            }
+            else
+            {
+                // Cached descriptor sets must keep their content, so use a new one
+                m_descriptorSet.reset();
+            }
+        }
         if (!m_descriptorSet)
         {
-            m_descriptorSet = DescriptorSet::create(DescriptorPool::create(m_descriptorSetLayout));
+            m_descriptorSet = DescriptorSet::create(m_descriptorSetLayout);
             m_mustUpdateDescriptorInfos = true;
         }
         if (m_mustUpdateDescriptorInfos)
         {
             m_mustUpdateDescriptorInfos = false;
             m_descriptorSet->updateDescriptorInfos(m_memoryObjects.fetchDescriptorInfos());
+
+            if (useCache)
+            {
+                m_descriptorSetCache.push_front({memoryObjectsHash, m_memoryObjects, m_descriptorSet});
+                if (m_descriptorSetCache.size() > g_maxCachedDescriptorSets)
+                    m_descriptorSetCache.pop_back();
+            }
         }
     }
 
@@ -183,7 +302,15 @@ void Pipeline::prepare()
             throw vk::LogicError("Push constants size exceeded: " + to_string(m_pushConstants.size()) + " > " + to_string(maxPushConstantsSize));
 
         vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
-        if (!m_descriptorSetLayout->isEmpty())
+        vk::DescriptorSetLayout descriptorSetLayouts[2];
+        if (m_descriptorHeap)
+        {
+            descriptorSetLayouts[0] = *static_cast<const vk::DescriptorSetLayout *>(*m_descriptorSetLayout);
+            descriptorSetLayouts[1] = m_descriptorHeap->descriptorSetLayout();
+            pipelineLayoutInfo.setLayoutCount = 2;
+            pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts;
+        }
+        else if (!m_descriptorSetLayout->isEmpty())
         {
             pipelineLayoutInfo.setLayoutCount = 1;
             pipelineLayoutInfo.pSetLayouts = *m_descriptorSetLayout;
@@ -193,7 +320,44 @@ void Pipeline::prepare()
             pipelineLayoutInfo.pushConstantRangeCount = 1;
             pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
         }
-        m_pipelineLayout = m_device->createPipelineLayoutUnique(pipelineLayoutInfo, nullptr, m_dld);
+        auto createPipelineLayout = [&] {
+            return m_device->createPipelineLayoutUnique(pipelineLayoutInfo, nullptr, m_dld);
+        };
+
+        m_pipelineLayoutKey.clear();
+
+        // Pipeline layouts are compatible if their descriptor set layouts are identically defined,
+        // but immutable samplers can't be reliably identified by their handles.
+        const auto &descriptorTypes = m_descriptorSetLayout->descriptorTypes();
+        const bool canCache = none_of(descriptorTypes.begin(), descriptorTypes.end(), [](const DescriptorType &descriptorType) {
+#ifndef QMVK_NO_GRAPHICS
+            return !descriptorType.immutableSamplers.empty();
+#else
+            return false;
+#endif
+        });
+        if (canCache)
+        {
+            PipelineObjectCache::appendKey(m_pipelineLayoutKey, pushConstantRange.stageFlags);
+            PipelineObjectCache::appendKey(m_pipelineLayoutKey, pushConstantRange.size);
+            PipelineObjectCache::appendKey(m_pipelineLayoutKey, m_descriptorSetLayout->isPushDescriptor());
+            PipelineObjectCache::appendKey(m_pipelineLayoutKey, static_cast<bool>(m_descriptorHeap));
+            for (auto &&descriptorType : descriptorTypes)
+            {
+                PipelineObjectCache::appendKey(m_pipelineLayoutKey, descriptorType.type);
+                PipelineObjectCache::appendKey(m_pipelineLayoutKey, descriptorType.descriptorCount);
+            }
+            if (m_descriptorHeap)
+            {
+                for (uint32_t i = 0; i < DescriptorHeap::BindingsCount; ++i)
+                    PipelineObjectCache::appendKey(m_pipelineLayoutKey, m_descriptorHeap->size(static_cast<DescriptorHeap::Binding>(i)));
+            }
+            m_pipelineLayout = m_device->pipelineObjectCache()->pipelineLayout(m_pipelineLayoutKey, createPipelineLayout);
+        }
+        else
+        {
+            m_pipelineLayout = make_shared<vk::UniquePipelineLayout>(createPipelineLayout());
+        }
 
         createPipeline();
         m_mustRecreate = false;
@@ -204,7 +368,7 @@ void Pipeline::prepareObjects(
     const shared_ptr<CommandBuffer> &commandBuffer,
     const MemoryObjectDescrs &memoryObjects)
 {
-    memoryObjects.prepareObjects(*commandBuffer, m_objectsPipelineStageFlags);
+    memoryObjects.prepareObjects(*commandBuffer, m_device, m_objectsPipelineStageFlags);
 }
 void Pipeline::prepareObjects(
     const shared_ptr<CommandBuffer> &commandBuffer)
@@ -218,7 +382,7 @@ void Pipeline::finalizeObjects(
     bool genMipmapsOnWrite,
     bool resetPipelineStageFlags)
 {
-    memoryObjects.finalizeObjects(*commandBuffer, genMipmapsOnWrite, resetPipelineStageFlags);
+    memoryObjects.finalizeObjects(*commandBuffer, m_device, genMipmapsOnWrite, resetPipelineStageFlags);
 }
 void Pipeline::finalizeObjects(
     const shared_ptr<CommandBuffer> &commandBuffer,
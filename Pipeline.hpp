@@ -10,6 +10,8 @@
 
 #include "MemoryObjectDescrs.hpp"
 
+#include <functional>
+#include <list>
 #include <map>
 
 namespace QmVk {
@@ -21,10 +23,18 @@ class MemoryObjectDescr;
 class DescriptorSetLayout;
 class DescriptorPool;
 class DescriptorSet;
+class DescriptorHeap;
 class CommandBuffer;
 
 class QMVK_EXPORT Pipeline
 {
+    struct CachedDescriptorSet
+    {
+        size_t hash;
+        MemoryObjectDescrs memoryObjects;
+        shared_ptr<DescriptorSet> descriptorSet;
+    };
+
 protected:
     Pipeline(
         const shared_ptr<Device> &device,
@@ -48,6 +58,12 @@ protected:
         vector<uint32_t> &specializationData
     ) const;
 
+    // "key" must describe everything except the pipeline layout which is appended automatically
+    void setPipeline(
+        string &&key,
+        const function<vk::UniquePipeline()> &create
+    );
+
     void pushConstants(
         const shared_ptr<CommandBuffer> &commandBuffer
     );
@@ -60,6 +76,13 @@ public:
     template<typename T>
     inline T *pushConstants();
 
+    // Records descriptors directly into the command buffer, no descriptor sets are allocated.
+    // Returns false if "VK_KHR_push_descriptor" is not enabled.
+    bool setPushDescriptors(bool pushDescriptors);
+
+    // Bound at set 1, the memory objects are always at set 0
+    void setDescriptorHeap(const shared_ptr<DescriptorHeap> &descriptorHeap);
+
     void createDescriptorSetFromPool(const shared_ptr<DescriptorPool> &descriptorPool);
     void setMemoryObjects(const MemoryObjectDescrs &memoryObjects);
 
@@ -96,14 +119,19 @@ protected:
     vector<uint8_t> m_pushConstants;
     MemoryObjectDescrs m_memoryObjects;
 
+    bool m_pushDescriptors = false;
     bool m_mustUpdateDescriptorInfos = false;
     bool m_mustRecreate = true;
 
     shared_ptr<DescriptorSetLayout> m_descriptorSetLayout;
     shared_ptr<DescriptorSet> m_descriptorSet;
+    bool m_externalDescriptorSet = false;
+    list<CachedDescriptorSet> m_descriptorSetCache; // Most recently used first
+    shared_ptr<DescriptorHeap> m_descriptorHeap;
 
-    vk::UniquePipelineLayout m_pipelineLayout;
-    vk::UniquePipeline m_pipeline;
+    string m_pipelineLayoutKey; // Empty if pipeline objects can't be cached
+    shared_ptr<vk::UniquePipelineLayout> m_pipelineLayout;
+    shared_ptr<vk::UniquePipeline> m_pipeline;
 };
 
 /* Inline implementation */
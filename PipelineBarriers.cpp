@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "PipelineBarriers.hpp"
+#include "Device.hpp"
+
+namespace QmVk {
+
+static inline vk::AccessFlags2 toAccessFlags2(vk::AccessFlags accessFlags)
+{
+    // Legacy access bits have the same values in "vk::AccessFlags2"
+    return vk::AccessFlags2(static_cast<VkAccessFlags>(accessFlags));
+}
+
+PipelineBarriers::PipelineBarriers(
+    const shared_ptr<Device> &device,
+    vk::PipelineStageFlags2 transferStage)
+    : m_device(device)
+    , m_sync2(device->hasSync2())
+    , m_transferStage(transferStage)
+{}
+PipelineBarriers::~PipelineBarriers()
+{}
+
+inline vk::PipelineStageFlags2 PipelineBarriers::getSrcStage2(vk::PipelineStageFlags stage) const
+{
+    // Legacy stage bits have the same values in "vk::PipelineStageFlags2"
+    return vk::PipelineStageFlags2(static_cast<VkPipelineStageFlags>(stage));
+}
+inline vk::PipelineStageFlags2 PipelineBarriers::getDstStage2(vk::PipelineStageFlags stage) const
+{
+    auto stage2 = getSrcStage2(stage);
+    if (stage & vk::PipelineStageFlagBits::eTransfer)
+    {
+        stage2 &= ~vk::PipelineStageFlags2(vk::PipelineStageFlagBits2::eAllTransfer);
+        stage2 |= m_transferStage;
+    }
+    return stage2;
+}
+
+void PipelineBarriers::addBufferBarrier(
+    vk::PipelineStageFlags srcStage,
+    vk::PipelineStageFlags dstStage,
+    const vk::BufferMemoryBarrier &barrier)
+{
+    if (m_sync2)
+    {
+        m_bufferBarriers2.emplace_back(
+            getSrcStage2(srcStage),
+            toAccessFlags2(barrier.srcAccessMask),
+            getDstStage2(dstStage),
+            toAccessFlags2(barrier.dstAccessMask),
+            barrier.srcQueueFamilyIndex,
+            barrier.dstQueueFamilyIndex,
+            barrier.buffer,
+            barrier.offset,
+            barrier.size
+        );
+        return;
+    }
+
+    m_srcStage |= srcStage;
+    m_dstStage |= dstStage;
+    m_bufferBarriers.push_back(barrier);
+}
+void PipelineBarriers::addImageBarrier(
+    vk::PipelineStageFlags srcStage,
+    vk::PipelineStageFlags dstStage,
+    const vk::ImageMemoryBarrier &barrier)
+{
+    if (m_sync2)
+    {
+        m_imageBarriers2.emplace_back(
+            getSrcStage2(srcStage),
+            toAccessFlags2(barrier.srcAccessMask),
+            getDstStage2(dstStage),
+            toAccessFlags2(barrier.dstAccessMask),
+            barrier.oldLayout,
+            barrier.newLayout,
+            barrier.srcQueueFamilyIndex,
+            barrier.dstQueueFamilyIndex,
+            barrier.image,
+            barrier.subresourceRange
+        );
+        return;
+    }
+
+    m_srcStage |= srcStage;
+    m_dstStage |= dstStage;
+    m_imageBarriers.push_back(barrier);
+}
+
+PipelineBarriers &PipelineBarriers::ownershipBarriers()
+{
+    if (!m_ownershipBarriers)
+        m_ownershipBarriers = make_unique<PipelineBarriers>(m_device, m_transferStage);
+    return *m_ownershipBarriers;
+}
+
+void PipelineBarriers::record(vk::CommandBuffer commandBuffer)
+{
+    if (m_ownershipBarriers)
+        m_ownershipBarriers->record(commandBuffer);
+
+    if (isEmpty())
+        return;
+
+    if (m_sync2)
+    {
+        vk::DependencyInfo dependencyInfo;
+        dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferBarriers2.size());
+        dependencyInfo.pBufferMemoryBarriers = m_bufferBarriers2.data();
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_imageBarriers2.size());
+        dependencyInfo.pImageMemoryBarriers = m_imageBarriers2.data();
+
+        // The dispatcher falls back to "vkCmdPipelineBarrier2KHR" if Vulkan 1.3 is not available
+        commandBuffer.pipelineBarrier2(dependencyInfo, m_device->dld());
+
+        m_bufferBarriers2.clear();
+        m_imageBarriers2.clear();
+        return;
+    }
+
+    commandBuffer.pipelineBarrier(
+        m_srcStage,
+        m_dstStage,
+        vk::DependencyFlags(),
+        0,
+        nullptr,
+        static_cast<uint32_t>(m_bufferBarriers.size()),
+        m_bufferBarriers.data(),
+        static_cast<uint32_t>(m_imageBarriers.size()),
+        m_imageBarriers.data(),
+        m_device->dld()
+    );
+
+    m_srcStage = vk::PipelineStageFlags();
+    m_dstStage = vk::PipelineStageFlags();
+    m_bufferBarriers.clear();
+    m_imageBarriers.clear();
+}
+
+}
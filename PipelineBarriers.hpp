@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+
+// Collects memory barriers and records them as a single pipeline barrier
+// command. Uses synchronization2 with per-barrier stage masks if available,
+// otherwise stage masks are merged.
+class QMVK_EXPORT PipelineBarriers
+{
+    PipelineBarriers(const PipelineBarriers &) = delete;
+
+public:
+    // "transferStage" narrows the transfer destination stage for synchronization2,
+    // e.g. "eCopy", "eBlit" or "eClear".
+    PipelineBarriers(
+        const shared_ptr<Device> &device,
+        vk::PipelineStageFlags2 transferStage = vk::PipelineStageFlagBits2::eAllTransfer
+    );
+    ~PipelineBarriers();
+
+public:
+    inline bool usesSync2() const;
+
+    // Transfer stages the transfer destination stage is narrowed to
+    inline vk::PipelineStageFlags2 transferStage() const;
+
+    inline bool isEmpty() const;
+
+    void addBufferBarrier(
+        vk::PipelineStageFlags srcStage,
+        vk::PipelineStageFlags dstStage,
+        const vk::BufferMemoryBarrier &barrier
+    );
+    void addImageBarrier(
+        vk::PipelineStageFlags srcStage,
+        vk::PipelineStageFlags dstStage,
+        const vk::ImageMemoryBarrier &barrier
+    );
+
+    // Queue family ownership acquire barriers, they're recorded before the other barriers
+    PipelineBarriers &ownershipBarriers();
+
+    // Records all collected barriers (if any) and clears them
+    void record(vk::CommandBuffer commandBuffer);
+
+private:
+    inline vk::PipelineStageFlags2 getSrcStage2(vk::PipelineStageFlags stage) const;
+    inline vk::PipelineStageFlags2 getDstStage2(vk::PipelineStageFlags stage) const;
+
+private:
+    const shared_ptr<Device> m_device;
+    const bool m_sync2;
+    const vk::PipelineStageFlags2 m_transferStage;
+
+    vk::PipelineStageFlags m_srcStage;
+    vk::PipelineStageFlags m_dstStage;
+
+    vector<vk::BufferMemoryBarrier> m_bufferBarriers;
+    vector<vk::ImageMemoryBarrier> m_imageBarriers;
+
+    vector<vk::BufferMemoryBarrier2> m_bufferBarriers2;
+    vector<vk::ImageMemoryBarrier2> m_imageBarriers2;
+
+    unique_ptr<PipelineBarriers> m_ownershipBarriers;
+};
+
+/* Inline implementation */
+
+bool PipelineBarriers::usesSync2() const
+{
+    return m_sync2;
+}
+
+vk::PipelineStageFlags2 PipelineBarriers::transferStage() const
+{
+    return m_sync2 ? m_transferStage : vk::PipelineStageFlagBits2::eAllTransfer;
+}
+
+bool PipelineBarriers::isEmpty() const
+{
+    return (m_bufferBarriers.empty() && m_imageBarriers.empty() && m_bufferBarriers2.empty() && m_imageBarriers2.empty())
+        && (!m_ownershipBarriers || m_ownershipBarriers->isEmpty());
+}
+
+}
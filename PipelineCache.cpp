@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "PipelineCache.hpp"
+#include "PhysicalDevice.hpp"
+#include "Device.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+namespace QmVk {
+
+// "VkPipelineCacheHeaderVersionOne" fields
+static constexpr size_t g_headerSize = 16 + VK_UUID_SIZE;
+
+PipelineCache::PipelineCache(Device &device)
+    : m_device(device)
+{
+    m_pipelineCache = m_device.createPipelineCacheUnique(vk::PipelineCacheCreateInfo(), nullptr, m_device.dld());
+}
+PipelineCache::~PipelineCache()
+{}
+
+bool PipelineCache::load(const string &filePath)
+{
+    vector<uint8_t> data;
+    {
+        ifstream file(filePath, ios::binary | ios::ate);
+        if (!file)
+            return false;
+
+        const auto size = file.tellg();
+        if (size <= 0)
+            return false;
+
+        data.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char *>(data.data()), data.size()))
+            return false;
+    }
+
+    if (!isCompatible(data))
+        return false;
+
+    vk::PipelineCacheCreateInfo createInfo;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.data();
+
+    try
+    {
+        auto srcPipelineCache = m_device.createPipelineCacheUnique(createInfo, nullptr, m_device.dld());
+
+        lock_guard<mutex> locker(m_mutex);
+        m_device.mergePipelineCaches(*m_pipelineCache, *srcPipelineCache, m_device.dld());
+    }
+    catch (const vk::SystemError &)
+    {
+        return false;
+    }
+
+    return true;
+}
+bool PipelineCache::save(const string &filePath) const
+{
+    const auto data = this->data();
+    if (data.empty())
+        return false;
+
+    const auto tmpFilePath = filePath + ".tmp";
+    {
+        ofstream file(tmpFilePath, ios::binary | ios::trunc);
+        if (!file)
+            return false;
+
+        file.write(reinterpret_cast<const char *>(data.data()), data.size());
+        file.close();
+        if (!file)
+        {
+            error_code ec;
+            filesystem::remove(tmpFilePath, ec);
+            return false;
+        }
+    }
+
+    error_code ec;
+    filesystem::rename(tmpFilePath, filePath, ec);
+    if (ec)
+    {
+        filesystem::remove(tmpFilePath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+vector<uint8_t> PipelineCache::data() const
+{
+    lock_guard<mutex> locker(m_mutex);
+    return m_device.getPipelineCacheData(*m_pipelineCache, m_device.dld());
+}
+
+bool PipelineCache::isCompatible(const vector<uint8_t> &data) const
+{
+    if (data.size() < g_headerSize)
+        return false;
+
+    uint32_t header[4];
+    memcpy(header, data.data(), sizeof(header));
+
+    const uint32_t headerSize = header[0];
+    const uint32_t headerVersion = header[1];
+    const uint32_t vendorID = header[2];
+    const uint32_t deviceID = header[3];
+
+    if (headerSize < g_headerSize || headerSize > data.size())
+        return false;
+    if (headerVersion != static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne))
+        return false;
+
+    const auto &properties = m_device.physicalDevice()->properties();
+    if (vendorID != properties.vendorID || deviceID != properties.deviceID)
+        return false;
+    if (memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0)
+        return false;
+
+    return true;
+}
+
+}
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <mutex>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+
+class QMVK_EXPORT PipelineCache
+{
+    PipelineCache(const PipelineCache &) = delete;
+
+public:
+    PipelineCache(Device &device);
+    ~PipelineCache();
+
+public:
+    // Merges the cache data from file if it matches the device, call it before creating pipelines
+    bool load(const string &filePath);
+    // Writes to a temporary file and renames it, so the file is never partially written
+    bool save(const string &filePath) const;
+
+    vector<uint8_t> data() const;
+
+    bool isCompatible(const vector<uint8_t> &data) const;
+
+public:
+    inline operator vk::PipelineCache() const;
+
+private:
+    Device &m_device;
+
+    mutable mutex m_mutex;
+    vk::UniquePipelineCache m_pipelineCache;
+};
+
+/* Inline implementation */
+
+PipelineCache::operator vk::PipelineCache() const
+{
+    return *m_pipelineCache;
+}
+
+}
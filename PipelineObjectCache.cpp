@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "PipelineObjectCache.hpp"
+
+#include <unordered_map>
+#include <list>
+
+namespace QmVk {
+
+static constexpr size_t g_maxPipelineLayouts = 64;
+static constexpr size_t g_maxPipelines = 256;
+
+template<typename T>
+class PipelineObjectCache::Lru
+{
+    using Entry = pair<string, shared_ptr<T>>;
+
+public:
+    Lru(size_t maxCount)
+        : m_maxCount(maxCount)
+    {}
+
+    shared_ptr<T> find(const string &key)
+    {
+        auto it = m_map.find(key);
+        if (it == m_map.end())
+            return nullptr;
+
+        m_list.splice(m_list.begin(), m_list, it->second);
+        return it->second->second;
+    }
+    shared_ptr<T> insert(const string &key, shared_ptr<T> &&value)
+    {
+        // Another thread might have created the same object in the meantime
+        if (auto existing = find(key))
+            return existing;
+
+        m_list.emplace_front(key, move(value));
+        m_map.emplace(key, m_list.begin());
+
+        if (m_list.size() > m_maxCount)
+        {
+            // Objects still in use are kept alive by their users
+            m_map.erase(m_list.back().first);
+            m_list.pop_back();
+        }
+
+        return m_list.front().second;
+    }
+    void clear()
+    {
+        m_map.clear();
+        m_list.clear();
+    }
+
+private:
+    const size_t m_maxCount;
+    list<Entry> m_list;
+    unordered_map<string, typename list<Entry>::iterator> m_map;
+};
+
+PipelineObjectCache::PipelineObjectCache()
+    : m_pipelineLayouts(make_unique<Lru<vk::UniquePipelineLayout>>(g_maxPipelineLayouts))
+    , m_pipelines(make_unique<Lru<vk::UniquePipeline>>(g_maxPipelines))
+{}
+PipelineObjectCache::~PipelineObjectCache()
+{}
+
+PipelineObjectCache::PipelineLayoutPtr PipelineObjectCache::pipelineLayout(
+    const string &key,
+    const function<vk::UniquePipelineLayout()> &create)
+{
+    {
+        lock_guard<mutex> locker(m_mutex);
+        if (auto pipelineLayout = m_pipelineLayouts->find(key))
+            return pipelineLayout;
+    }
+
+    auto pipelineLayout = make_shared<vk::UniquePipelineLayout>(create());
+
+    lock_guard<mutex> locker(m_mutex);
+    return m_pipelineLayouts->insert(key, move(pipelineLayout));
+}
+PipelineObjectCache::PipelinePtr PipelineObjectCache::pipeline(
+    const string &key,
+    const function<vk::UniquePipeline()> &create)
+{
+    {
+        lock_guard<mutex> locker(m_mutex);
+        if (auto pipeline = m_pipelines->find(key))
+            return pipeline;
+    }
+
+    auto pipeline = make_shared<vk::UniquePipeline>(create());
+
+    lock_guard<mutex> locker(m_mutex);
+    return m_pipelines->insert(key, move(pipeline));
+}
+
+void PipelineObjectCache::clear()
+{
+    lock_guard<mutex> locker(m_mutex);
+    m_pipelines->clear();
+    m_pipelineLayouts->clear();
+}
+
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <type_traits>
+#include <functional>
+#include <memory>
+#include <string>
+#include <mutex>
+
+namespace QmVk {
+
+using namespace std;
+
+// Least recently used cache of pipelines and pipeline layouts, so switching
+// between already used variants doesn't recompile them.
+class QMVK_EXPORT PipelineObjectCache
+{
+    PipelineObjectCache(const PipelineObjectCache &) = delete;
+
+    template<typename T>
+    class Lru;
+
+public:
+    using PipelineLayoutPtr = shared_ptr<vk::UniquePipelineLayout>;
+    using PipelinePtr = shared_ptr<vk::UniquePipeline>;
+
+public:
+    PipelineObjectCache();
+    ~PipelineObjectCache();
+
+public:
+    template<typename T>
+    static inline void appendKey(string &key, const T &value);
+    template<typename T>
+    static inline void appendKey(string &key, const vector<T> &values);
+
+    // Objects are created outside the lock, so pipelines can be compiled concurrently
+    PipelineLayoutPtr pipelineLayout(
+        const string &key,
+        const function<vk::UniquePipelineLayout()> &create
+    );
+    PipelinePtr pipeline(
+        const string &key,
+        const function<vk::UniquePipeline()> &create
+    );
+
+    void clear();
+
+private:
+    mutex m_mutex;
+    unique_ptr<Lru<vk::UniquePipelineLayout>> m_pipelineLayouts;
+    unique_ptr<Lru<vk::UniquePipeline>> m_pipelines;
+};
+
+/* Inline implementation */
+
+template<typename T>
+void PipelineObjectCache::appendKey(string &key, const T &value)
+{
+    static_assert(is_trivially_copyable<T>::value);
+    key.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+template<typename T>
+void PipelineObjectCache::appendKey(string &key, const vector<T> &values)
+{
+    static_assert(is_trivially_copyable<T>::value);
+    appendKey(key, values.size());
+    key.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+}
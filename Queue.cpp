@@ -59,6 +59,10 @@ void Queue::submitCommandBuffer(vk::SubmitInfo &&submitInfo)
     submit(submitInfo, *m_fence, dld());
     m_fenceResetNeeded = true;
 }
+void Queue::submitCommandBuffer(vk::SubmitInfo &&submitInfo, vk::Fence fence)
+{
+    submit(submitInfo, fence, dld());
+}
 void Queue::waitForCommandsFinished()
 {
     auto result = m_device->waitForFences(
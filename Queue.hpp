@@ -49,6 +49,7 @@ public:
     unique_lock<mutex> lock();
 
     void submitCommandBuffer(vk::SubmitInfo &&submitInfo);
+    void submitCommandBuffer(vk::SubmitInfo &&submitInfo, vk::Fence fence);
     void waitForCommandsFinished();
 
 private:
@@ -7,8 +7,12 @@
 #include "ShaderModule.hpp"
 #include "Device.hpp"
 
+#include <atomic>
+
 namespace QmVk {
 
+static atomic<uint64_t> g_lastId(0);
+
 shared_ptr<ShaderModule> ShaderModule::create(
     const shared_ptr<Device> &device,
     vk::ShaderStageFlagBits stage,
@@ -27,6 +31,7 @@ ShaderModule::ShaderModule(
     vk::ShaderStageFlagBits stage)
     : m_device(device)
     , m_stage(stage)
+    , m_id(++g_lastId)
 {}
 ShaderModule::~ShaderModule()
 {}
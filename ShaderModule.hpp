@@ -40,6 +40,9 @@ private:
 public:
     inline vk::ShaderStageFlagBits stage() const;
 
+    // Unique during the application lifetime, unlike the handle or the pointer
+    inline uint64_t id() const;
+
     vk::PipelineShaderStageCreateInfo getPipelineShaderStageCreateInfo(
         const vk::SpecializationInfo &specializationInfo
     ) const;
@@ -47,6 +50,7 @@ public:
 private:
     const shared_ptr<Device> m_device;
     const vk::ShaderStageFlagBits m_stage;
+    const uint64_t m_id;
 
     vk::UniqueShaderModule m_shaderModule;
 };
@@ -58,4 +62,9 @@ vk::ShaderStageFlagBits ShaderModule::stage() const
     return m_stage;
 }
 
+uint64_t ShaderModule::id() const
+{
+    return m_id;
+}
+
 }
@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "StagingUploader.hpp"
+#include "CommandBufferRing.hpp"
+#include "MemoryPropertyFlags.hpp"
+#include "PhysicalDevice.hpp"
+#include "CommandBuffer.hpp"
+#include "Device.hpp"
+#include "Buffer.hpp"
+#ifndef QMVK_NO_GRAPHICS
+#   include "Image.hpp"
+#endif
+
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+
+namespace QmVk {
+
+static constexpr uint32_t g_commandBuffersCount = 3;
+
+shared_ptr<StagingUploader> StagingUploader::create(
+    const shared_ptr<Device> &device,
+    vk::DeviceSize ringSize,
+    const shared_ptr<Queue> &queue)
+{
+    auto stagingUploader = make_shared<StagingUploader>(
+        device,
+        ringSize,
+        queue
+    );
+    stagingUploader->init();
+    return stagingUploader;
+}
+
+StagingUploader::StagingUploader(
+    const shared_ptr<Device> &device,
+    vk::DeviceSize ringSize,
+    const shared_ptr<Queue> &queue)
+    : m_device(device)
+    , m_ringSize(ringSize)
+    , m_queue(queue)
+{}
+StagingUploader::~StagingUploader()
+{
+    if (m_commandBufferRing)
+        m_commandBufferRing->waitAll();
+}
+
+void StagingUploader::init()
+{
+    if (!m_queue)
+        m_queue = m_device->firstQueue();
+
+    m_commandBufferRing = CommandBufferRing::create(m_queue, g_commandBuffersCount);
+
+    m_alignment = max<vk::DeviceSize>(m_alignment, m_device->physicalDevice()->limits().optimalBufferCopyOffsetAlignment);
+
+    MemoryPropertyFlags memoryPropertyFlags;
+    memoryPropertyFlags.required = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    m_stagingBuffer = Buffer::create(
+        m_device,
+        m_ringSize,
+        vk::BufferUsageFlagBits::eTransferSrc,
+        memoryPropertyFlags
+    );
+    m_mapped = m_stagingBuffer->map<uint8_t>();
+}
+
+void StagingUploader::uploadBuffer(
+    const shared_ptr<Buffer> &dstBuffer,
+    const void *data,
+    vk::DeviceSize size,
+    vk::DeviceSize dstOffset)
+{
+    if (dstOffset + size > dstBuffer->size())
+        throw vk::LogicError("Destination buffer overflow");
+
+    lock_guard<mutex> locker(m_mutex);
+
+    auto src = static_cast<const uint8_t *>(data);
+    while (size > 0)
+    {
+        const vk::DeviceSize partSize = min(size, m_ringSize);
+        const vk::DeviceSize srcOffset = allocate(partSize, m_alignment);
+        memcpy(m_mapped + srcOffset, src, partSize);
+
+        PendingCopy pendingCopy = {};
+        pendingCopy.dstBuffer = dstBuffer;
+        pendingCopy.srcOffset = srcOffset;
+        pendingCopy.dstOffset = dstOffset;
+        pendingCopy.size = partSize;
+        m_pendingCopies.push_back(move(pendingCopy));
+
+        src += partSize;
+        dstOffset += partSize;
+        size -= partSize;
+    }
+}
+#ifndef QMVK_NO_GRAPHICS
+void StagingUploader::uploadImage(
+    const shared_ptr<Image> &dstImage,
+    const void *data,
+    vk::DeviceSize size,
+    uint32_t plane,
+    uint32_t rowLength)
+{
+    if (plane >= dstImage->numPlanes())
+        throw vk::LogicError("Invalid image plane");
+
+    const auto planeSize = dstImage->size(plane);
+    if (rowLength != 0 && rowLength < planeSize.width)
+        throw vk::LogicError("Row length is smaller than the plane width");
+
+    const vk::DeviceSize texelSize = Image::getTexelSize(dstImage->format(plane));
+    if (texelSize > 0)
+    {
+        const vk::DeviceSize rowTexels = rowLength ? rowLength : planeSize.width;
+        const vk::DeviceSize footprint = ((planeSize.height - 1) * rowTexels + planeSize.width) * texelSize;
+        if (size < footprint)
+            throw vk::LogicError("Image plane data is too small");
+    }
+
+    if (size > m_ringSize)
+        throw vk::LogicError("Image plane doesn't fit in the staging ring");
+
+    lock_guard<mutex> locker(m_mutex);
+
+    // Image copies must start at a multiple of the texel size, e.g. 3 bytes for RGB
+    const vk::DeviceSize srcOffset = allocate(size, texelSize > 0 ? lcm(m_alignment, texelSize) : m_alignment);
+    memcpy(m_mapped + srcOffset, data, size);
+
+    PendingCopy pendingCopy = {};
+    pendingCopy.dstImage = dstImage;
+    pendingCopy.plane = plane;
+    pendingCopy.rowLength = rowLength;
+    pendingCopy.srcOffset = srcOffset;
+    pendingCopy.size = size;
+    m_pendingCopies.push_back(move(pendingCopy));
+}
+#endif
+
+Completion StagingUploader::flush()
+{
+    lock_guard<mutex> locker(m_mutex);
+    return flushLocked();
+}
+
+vk::DeviceSize StagingUploader::allocate(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+    // The alignment doesn't have to be a power of two
+    auto alignedTo = [alignment](vk::DeviceSize value) {
+        return (value + alignment - 1) / alignment * alignment;
+    };
+
+    size = alignedTo(max<vk::DeviceSize>(size, 1));
+    if (size > m_ringSize)
+        size = m_ringSize;
+
+    for (;;)
+    {
+        while (!m_batches.empty() && m_batches.front().completion.isFinished())
+            m_batches.pop_front();
+
+        const bool hasPending = !m_pendingCopies.empty();
+        if (m_batches.empty() && !hasPending)
+            m_head = 0;
+
+        const vk::DeviceSize tail = !m_batches.empty()
+            ? m_batches.front().start
+            : hasPending ? m_pendingStart : m_head
+        ;
+        const bool isEmpty = (m_batches.empty() && !hasPending);
+        const vk::DeviceSize head = alignedTo(m_head);
+
+        vk::DeviceSize offset = m_ringSize;
+        if (isEmpty || m_head > tail)
+        {
+            if (head + size <= m_ringSize)
+                offset = head;
+            else if (size < tail)
+                offset = 0;
+        }
+        else if (m_head < tail && head + size < tail)
+        {
+            offset = head;
+        }
+
+        if (offset != m_ringSize)
+        {
+            if (!hasPending)
+                m_pendingStart = offset;
+            m_head = offset + size;
+            return offset;
+        }
+
+        if (hasPending)
+            flushLocked();
+        else
+            m_batches.front().completion.wait();
+    }
+}
+
+Completion StagingUploader::flushLocked()
+{
+    if (m_pendingCopies.empty())
+        return Completion();
+
+    auto commandBuffer = m_commandBufferRing->beginNext();
+    for (auto &&pendingCopy : m_pendingCopies)
+    {
+#ifndef QMVK_NO_GRAPHICS
+        if (pendingCopy.dstImage)
+        {
+            pendingCopy.dstImage->copyFromBuffer(
+                m_stagingBuffer,
+                pendingCopy.srcOffset,
+                pendingCopy.plane,
+                pendingCopy.rowLength,
+                commandBuffer
+            );
+            continue;
+        }
+#endif
+        vk::BufferCopy bufferCopy;
+        bufferCopy.srcOffset = pendingCopy.srcOffset;
+        bufferCopy.dstOffset = pendingCopy.dstOffset;
+        bufferCopy.size = pendingCopy.size;
+        m_stagingBuffer->copyTo(pendingCopy.dstBuffer, commandBuffer, &bufferCopy);
+    }
+    m_pendingCopies.clear();
+
+    auto completion = m_commandBufferRing->submit();
+    m_batches.push_back({m_pendingStart, completion});
+    return completion;
+}
+
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include "Completion.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+class Queue;
+class Buffer;
+#ifndef QMVK_NO_GRAPHICS
+class Image;
+#endif
+class CommandBufferRing;
+
+// Batches host to device uploads. The data is copied into a persistently mapped staging
+// ring immediately, the copies are recorded into one command buffer and submitted at once
+// on "flush()". If the ring is full, pending uploads are flushed and the oldest batches
+// are waited for.
+class QMVK_EXPORT StagingUploader
+{
+    struct PendingCopy
+    {
+        shared_ptr<Buffer> dstBuffer;
+#ifndef QMVK_NO_GRAPHICS
+        shared_ptr<Image> dstImage;
+        uint32_t plane;
+        uint32_t rowLength;
+#endif
+        vk::DeviceSize srcOffset;
+        vk::DeviceSize dstOffset;
+        vk::DeviceSize size;
+    };
+
+    struct Batch
+    {
+        vk::DeviceSize start;
+        Completion completion;
+    };
+
+public:
+    static shared_ptr<StagingUploader> create(
+        const shared_ptr<Device> &device,
+        vk::DeviceSize ringSize = 64 << 20,
+        const shared_ptr<Queue> &queue = nullptr // First queue by default
+    );
+
+public:
+    StagingUploader(
+        const shared_ptr<Device> &device,
+        vk::DeviceSize ringSize,
+        const shared_ptr<Queue> &queue
+    );
+    ~StagingUploader();
+
+private:
+    void init();
+
+public:
+    inline shared_ptr<Queue> queue() const;
+    inline vk::DeviceSize ringSize() const;
+
+    // Buffers larger than the ring are uploaded in parts
+    void uploadBuffer(
+        const shared_ptr<Buffer> &dstBuffer,
+        const void *data,
+        vk::DeviceSize size,
+        vk::DeviceSize dstOffset = 0
+    );
+#ifndef QMVK_NO_GRAPHICS
+    // Uploads the whole plane, "rowLength" is in texels (0 - tightly packed)
+    void uploadImage(
+        const shared_ptr<Image> &dstImage,
+        const void *data,
+        vk::DeviceSize size,
+        uint32_t plane = 0,
+        uint32_t rowLength = 0
+    );
+#endif
+
+    // Submits all pending uploads, returns an empty completion if there is nothing to submit
+    Completion flush();
+
+private:
+    vk::DeviceSize allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+    Completion flushLocked();
+
+private:
+    const shared_ptr<Device> m_device;
+    const vk::DeviceSize m_ringSize;
+
+    shared_ptr<Queue> m_queue;
+    shared_ptr<CommandBufferRing> m_commandBufferRing;
+
+    vk::DeviceSize m_alignment = 16;
+    shared_ptr<Buffer> m_stagingBuffer;
+    uint8_t *m_mapped = nullptr;
+
+    mutex m_mutex;
+    vk::DeviceSize m_head = 0;
+    vk::DeviceSize m_pendingStart = 0;
+    vector<PendingCopy> m_pendingCopies;
+    deque<Batch> m_batches;
+};
+
+/* Inline implementation */
+
+shared_ptr<Queue> StagingUploader::queue() const
+{
+    return m_queue;
+}
+vk::DeviceSize StagingUploader::ringSize() const
+{
+    return m_ringSize;
+}
+
+}
@@ -50,6 +50,7 @@ SwapChain::SwapChain(CreateInfo &createInfo)
     , m_dld(m_device->dld())
     , m_queue(move(createInfo.queue))
     , m_renderPass(move(createInfo.renderPass))
+    , m_format(m_renderPass ? m_renderPass->format() : createInfo.format)
     , m_surface(move(createInfo.surface))
     , m_oldSwapChain(move(createInfo.oldSwapChain))
 {}
@@ -58,6 +59,9 @@ SwapChain::~SwapChain()
 
 void SwapChain::init(CreateInfo &createInfo)
 {
+    if (m_format == vk::Format::eUndefined)
+        throw vk::LogicError("Swap chain format is not specified");
+
     const auto physicalDevice = m_device->physicalDevice();
 
     const auto surfaceCapabilities = physicalDevice->getSurfaceCapabilitiesKHR(m_surface, m_dld);
@@ -115,7 +119,7 @@ void SwapChain::init(CreateInfo &createInfo)
     vk::SwapchainCreateInfoKHR vkCreateInfo;
     vkCreateInfo.surface = m_surface;
     vkCreateInfo.minImageCount = createInfo.imageCount;
-    vkCreateInfo.imageFormat = m_renderPass->format();
+    vkCreateInfo.imageFormat = m_format;
     vkCreateInfo.imageColorSpace = createInfo.colorSpace;
     vkCreateInfo.imageExtent = m_size;
     vkCreateInfo.imageArrayLayers = 1;
@@ -138,27 +142,30 @@ void SwapChain::init(CreateInfo &createInfo)
 
     m_oldSwapChain.reset();
 
-    const auto swapChainImages = m_device->getSwapchainImagesKHR(*m_swapChain, m_dld);
-    for (auto &&swapChainImage : swapChainImages)
+    m_swapChainImages = m_device->getSwapchainImagesKHR(*m_swapChain, m_dld);
+    for (auto &&swapChainImage : m_swapChainImages)
     {
         vk::ImageViewCreateInfo imageViewCreateInfo;
         imageViewCreateInfo.image = swapChainImage;
         imageViewCreateInfo.viewType = vk::ImageViewType::e2D;
-        imageViewCreateInfo.format = m_renderPass->format();
+        imageViewCreateInfo.format = m_format;
         imageViewCreateInfo.components = vk::ComponentMapping();
         imageViewCreateInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
         imageViewCreateInfo.subresourceRange.levelCount = 1;
         imageViewCreateInfo.subresourceRange.layerCount = 1;
         m_swapChainImageViews.push_back(m_device->createImageViewUnique(imageViewCreateInfo, nullptr, m_dld));
 
-        vk::FramebufferCreateInfo framebufferCreateInfo;
-        framebufferCreateInfo.renderPass = *m_renderPass;
-        framebufferCreateInfo.attachmentCount = 1;
-        framebufferCreateInfo.pAttachments = &m_swapChainImageViews.back().get();
-        framebufferCreateInfo.width = m_size.width;
-        framebufferCreateInfo.height = m_size.height;
-        framebufferCreateInfo.layers = 1;
-        m_frameBuffers.push_back(m_device->createFramebufferUnique(framebufferCreateInfo, nullptr, m_dld));
+        if (m_renderPass)
+        {
+            vk::FramebufferCreateInfo framebufferCreateInfo;
+            framebufferCreateInfo.renderPass = *m_renderPass;
+            framebufferCreateInfo.attachmentCount = 1;
+            framebufferCreateInfo.pAttachments = &m_swapChainImageViews.back().get();
+            framebufferCreateInfo.width = m_size.width;
+            framebufferCreateInfo.height = m_size.height;
+            framebufferCreateInfo.layers = 1;
+            m_frameBuffers.push_back(m_device->createFramebufferUnique(framebufferCreateInfo, nullptr, m_dld));
+        }
 
         m_renderFinishedSem.push_back(Semaphore::create(m_device));
     }
@@ -177,6 +184,78 @@ vk::SubmitInfo SwapChain::getSubmitInfo(uint32_t imageIdx) const
     return submitInfo;
 }
 
+vk::Framebuffer SwapChain::frameBuffer(uint32_t idx) const
+{
+    if (!m_renderPass)
+        throw vk::LogicError("Swap chain has no framebuffers without render pass");
+
+    return *m_frameBuffers[idx];
+}
+
+void SwapChain::beginRendering(vk::CommandBuffer commandBuffer, uint32_t imageIdx, const vk::ClearColorValue *clearColor)
+{
+    assert(m_device->hasDynamicRendering());
+
+    vk::ImageMemoryBarrier barrier;
+    barrier.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+    barrier.oldLayout = vk::ImageLayout::eUndefined;
+    barrier.newLayout = vk::ImageLayout::eColorAttachmentOptimal;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_swapChainImages.at(imageIdx);
+    barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    commandBuffer.pipelineBarrier(
+        g_waitStage,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::DependencyFlags(),
+        0, nullptr,
+        0, nullptr,
+        1, &barrier,
+        m_dld
+    );
+
+    vk::RenderingAttachmentInfo colorAttachment;
+    colorAttachment.imageView = *m_swapChainImageViews[imageIdx];
+    colorAttachment.imageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+    colorAttachment.loadOp = clearColor ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eDontCare;
+    colorAttachment.storeOp = vk::AttachmentStoreOp::eStore;
+    if (clearColor)
+        colorAttachment.clearValue.color = *clearColor;
+
+    vk::RenderingInfo renderingInfo;
+    renderingInfo.renderArea.extent = m_size;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    commandBuffer.beginRendering(renderingInfo, m_dld);
+}
+void SwapChain::endRendering(vk::CommandBuffer commandBuffer, uint32_t imageIdx)
+{
+    commandBuffer.endRendering(m_dld);
+
+    vk::ImageMemoryBarrier barrier;
+    barrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+    barrier.oldLayout = vk::ImageLayout::eColorAttachmentOptimal;
+    barrier.newLayout = vk::ImageLayout::ePresentSrcKHR;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_swapChainImages.at(imageIdx);
+    barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::PipelineStageFlagBits::eBottomOfPipe,
+        vk::DependencyFlags(),
+        0, nullptr,
+        0, nullptr,
+        1, &barrier,
+        m_dld
+    );
+}
+
 void SwapChain::setHdrMetadata(const vk::HdrMetadataEXT &hdrMetadata)
 {
     assert(m_device->hasExtension(VK_EXT_HDR_METADATA_EXTENSION_NAME));
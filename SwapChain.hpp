@@ -28,7 +28,8 @@ public:
     {
         shared_ptr<Device> device;
         shared_ptr<Queue> queue;
-        shared_ptr<RenderPass> renderPass;
+        shared_ptr<RenderPass> renderPass; // If empty, no framebuffers are created, use "beginRendering()"
+        vk::Format format = vk::Format::eUndefined; // Used if there is no "renderPass"
         vk::SurfaceKHR surface;
         vk::Extent2D fallbackSize;
         vector<vk::PresentModeKHR> presentModes;
@@ -59,10 +60,19 @@ private:
 
 public:
     inline vk::Extent2D size() const;
+    inline vk::Format format() const;
 
     inline bool maybeSuboptimal() const;
 
-    inline vk::Framebuffer frameBuffer(uint32_t idx) const;
+    vk::Framebuffer frameBuffer(uint32_t idx) const;
+
+    inline vk::Image image(uint32_t idx) const;
+    inline vk::ImageView imageView(uint32_t idx) const;
+
+    // Dynamic rendering into the swap chain image, replaces the render pass begin/end.
+    // Image contents are discarded, they're cleared if "clearColor" is set.
+    void beginRendering(vk::CommandBuffer commandBuffer, uint32_t imageIdx, const vk::ClearColorValue *clearColor = nullptr);
+    void endRendering(vk::CommandBuffer commandBuffer, uint32_t imageIdx);
 
     vk::SubmitInfo getSubmitInfo(uint32_t imageIdx) const;
 
@@ -78,6 +88,7 @@ private:
     const vk::detail::DispatchLoaderDynamic &m_dld;
     const shared_ptr<Queue> m_queue;
     const shared_ptr<RenderPass> m_renderPass;
+    const vk::Format m_format;
     const vk::SurfaceKHR m_surface;
     vk::UniqueSwapchainKHR m_oldSwapChain;
 
@@ -87,6 +98,7 @@ private:
 
     vk::UniqueSwapchainKHR m_swapChain;
 
+    vector<vk::Image> m_swapChainImages;
     vector<vk::UniqueImageView> m_swapChainImageViews;
     vector<vk::UniqueFramebuffer> m_frameBuffers;
 
@@ -101,14 +113,23 @@ vk::Extent2D SwapChain::size() const
     return m_size;
 }
 
+vk::Format SwapChain::format() const
+{
+    return m_format;
+}
+
 bool SwapChain::maybeSuboptimal() const
 {
     return m_maybeSuboptimal;
 }
 
-vk::Framebuffer SwapChain::frameBuffer(uint32_t idx) const
+vk::Image SwapChain::image(uint32_t idx) const
+{
+    return m_swapChainImages[idx];
+}
+vk::ImageView SwapChain::imageView(uint32_t idx) const
 {
-    return *m_frameBuffers[idx];
+    return *m_swapChainImageViews[idx];
 }
 
 }
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "TimelineSemaphore.hpp"
+#include "Device.hpp"
+
+namespace QmVk {
+
+shared_ptr<TimelineSemaphore> TimelineSemaphore::create(
+    const shared_ptr<Device> &device,
+    uint64_t initialValue)
+{
+    auto semaphore = make_shared<TimelineSemaphore>(
+        device
+    );
+    semaphore->init(initialValue);
+    return semaphore;
+}
+
+TimelineSemaphore::TimelineSemaphore(
+    const shared_ptr<Device> &device)
+    : m_device(device)
+{}
+TimelineSemaphore::~TimelineSemaphore()
+{}
+
+void TimelineSemaphore::init(uint64_t initialValue)
+{
+    if (!m_device->hasTimelineSemaphore())
+        throw vk::LogicError("Timeline semaphore is not enabled");
+
+    vk::SemaphoreTypeCreateInfo typeCreateInfo;
+    typeCreateInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+    typeCreateInfo.initialValue = initialValue;
+
+    vk::SemaphoreCreateInfo createInfo;
+    createInfo.pNext = &typeCreateInfo;
+    m_semaphore = m_device->createSemaphoreUnique(createInfo, nullptr, m_device->dld());
+}
+
+uint64_t TimelineSemaphore::value() const
+{
+    return m_device->getSemaphoreCounterValue(*m_semaphore, m_device->dld());
+}
+
+void TimelineSemaphore::signal(uint64_t value)
+{
+    vk::SemaphoreSignalInfo signalInfo;
+    signalInfo.semaphore = *m_semaphore;
+    signalInfo.value = value;
+    m_device->signalSemaphore(signalInfo, m_device->dld());
+}
+
+bool TimelineSemaphore::wait(uint64_t value, uint64_t timeout) const
+{
+    vk::SemaphoreWaitInfo waitInfo;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &*m_semaphore;
+    waitInfo.pValues = &value;
+    return (m_device->waitSemaphores(waitInfo, timeout, m_device->dld()) != vk::Result::eTimeout);
+}
+
+}
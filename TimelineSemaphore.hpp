@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <limits>
+#include <memory>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+
+// Requires "Device::hasTimelineSemaphore()"
+class QMVK_EXPORT TimelineSemaphore
+{
+public:
+    // Semaphore value used in "CommandBuffer::endSubmit()", "stage" is used for waits only
+    struct Point
+    {
+        shared_ptr<TimelineSemaphore> semaphore;
+        uint64_t value = 0;
+        vk::PipelineStageFlags stage = vk::PipelineStageFlagBits::eAllCommands;
+    };
+
+public:
+    static shared_ptr<TimelineSemaphore> create(
+        const shared_ptr<Device> &device,
+        uint64_t initialValue = 0
+    );
+
+public:
+    TimelineSemaphore(
+        const shared_ptr<Device> &device
+    );
+    ~TimelineSemaphore();
+
+private:
+    void init(uint64_t initialValue);
+
+public:
+    inline shared_ptr<Device> device() const;
+
+    uint64_t value() const;
+
+    void signal(uint64_t value);
+
+    // Timeout is in nanoseconds, returns false on timeout
+    bool wait(uint64_t value, uint64_t timeout = numeric_limits<uint64_t>::max()) const;
+
+public:
+    inline operator const vk::Semaphore &() const;
+    inline operator const vk::Semaphore *() const;
+
+private:
+    const shared_ptr<Device> m_device;
+
+    vk::UniqueSemaphore m_semaphore;
+};
+
+/* Inline implementation */
+
+shared_ptr<Device> TimelineSemaphore::device() const
+{
+    return m_device;
+}
+
+TimelineSemaphore::operator const vk::Semaphore &() const
+{
+    return *m_semaphore;
+}
+TimelineSemaphore::operator const vk::Semaphore *() const
+{
+    return &*m_semaphore;
+}
+
+}
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "TimestampProfiler.hpp"
+#include "PhysicalDevice.hpp"
+#include "CommandBuffer.hpp"
+#include "Device.hpp"
+#include "Queue.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace QmVk {
+
+TimestampProfiler::Scope::Scope(
+    const shared_ptr<TimestampProfiler> &profiler,
+    const shared_ptr<CommandBuffer> &commandBuffer,
+    const string &name)
+    : m_profiler(profiler)
+    , m_commandBuffer(commandBuffer)
+    , m_zone(m_profiler->beginZone(m_commandBuffer, name))
+{}
+TimestampProfiler::Scope::~Scope()
+{
+    m_profiler->endZone(m_commandBuffer, m_zone);
+}
+
+shared_ptr<TimestampProfiler> TimestampProfiler::create(
+    const shared_ptr<Device> &device,
+    uint32_t maxPendingZones,
+    uint32_t historySize)
+{
+    auto timestampProfiler = make_shared<TimestampProfiler>(
+        device,
+        maxPendingZones,
+        historySize
+    );
+    timestampProfiler->init();
+    return timestampProfiler;
+}
+
+TimestampProfiler::TimestampProfiler(
+    const shared_ptr<Device> &device,
+    uint32_t maxPendingZones,
+    uint32_t historySize)
+    : m_device(device)
+    , m_maxPendingZones(max(maxPendingZones, 1u))
+    , m_historySize(max(historySize, 1u))
+{}
+TimestampProfiler::~TimestampProfiler()
+{}
+
+void TimestampProfiler::init()
+{
+    m_timestampPeriod = m_device->physicalDevice()->limits().timestampPeriod;
+
+    vk::QueryPoolCreateInfo queryPoolCreateInfo;
+    queryPoolCreateInfo.queryType = vk::QueryType::eTimestamp;
+    queryPoolCreateInfo.queryCount = m_maxPendingZones * 2;
+    m_queryPool = m_device->createQueryPoolUnique(queryPoolCreateInfo, nullptr, m_device->dld());
+
+    m_freeQueries.reserve(m_maxPendingZones);
+    for (uint32_t i = m_maxPendingZones; i-- > 0;)
+        m_freeQueries.push_back(i * 2);
+}
+
+TimestampProfiler::Zone TimestampProfiler::beginZone(const shared_ptr<CommandBuffer> &commandBuffer, const string &name)
+{
+    Zone zone;
+
+    const uint32_t timestampValidBits = m_device->physicalDevice()->getQueueProps(commandBuffer->queue()->queueFamilyIndex()).timestampValidBits;
+    if (timestampValidBits == 0)
+        return zone;
+
+    {
+        lock_guard<mutex> locker(m_mutex);
+
+        if (m_freeQueries.empty())
+            return zone;
+
+        zone.m_query = m_freeQueries.back();
+        m_freeQueries.pop_back();
+
+        auto &zoneSamples = m_zones[name];
+        if (zoneSamples.samples.capacity() == 0)
+            zoneSamples.samples.reserve(m_historySize);
+        zone.m_zoneSamples = &zoneSamples;
+    }
+
+    zone.m_timestampMask = (timestampValidBits >= 64)
+        ? numeric_limits<uint64_t>::max()
+        : (uint64_t(1) << timestampValidBits) - 1
+    ;
+
+    commandBuffer->resetQueryPool(*m_queryPool, zone.m_query, 2, commandBuffer->dld());
+    commandBuffer->writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *m_queryPool, zone.m_query, commandBuffer->dld());
+
+    // Queries are freed also if the zone is never ended, its results are not available then
+    const PendingZone pendingZone {
+        zone.m_zoneSamples,
+        zone.m_query,
+        zone.m_timestampMask,
+    };
+    weak_ptr<TimestampProfiler> timestampProfilerWeak = shared_from_this();
+    commandBuffer->addRecordingCallback([timestampProfilerWeak, pendingZone](bool executed) {
+        if (auto timestampProfiler = timestampProfilerWeak.lock())
+            timestampProfiler->readResults(pendingZone, executed);
+    });
+
+    return zone;
+}
+void TimestampProfiler::endZone(const shared_ptr<CommandBuffer> &commandBuffer, const Zone &zone)
+{
+    if (!zone.isValid())
+        return;
+
+    commandBuffer->writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *m_queryPool, zone.m_query + 1, commandBuffer->dld());
+}
+
+map<string, TimestampProfiler::Statistics> TimestampProfiler::statistics()
+{
+    map<string, Statistics> statistics;
+    vector<double> sorted;
+
+    lock_guard<mutex> locker(m_mutex);
+
+    for (auto &&zonePair : m_zones)
+    {
+        auto &&samples = zonePair.second.samples;
+        if (samples.empty())
+            continue;
+
+        sorted = samples;
+        sort(sorted.begin(), sorted.end());
+
+        auto &zoneStatistics = statistics[zonePair.first];
+        zoneStatistics.samples = sorted.size();
+        zoneStatistics.min = sorted.front();
+        for (auto &&sample : sorted)
+            zoneStatistics.avg += sample;
+        zoneStatistics.avg /= sorted.size();
+        zoneStatistics.p99 = sorted[(sorted.size() - 1) * 99 / 100];
+    }
+
+    return statistics;
+}
+void TimestampProfiler::clearStatistics()
+{
+    lock_guard<mutex> locker(m_mutex);
+    for (auto &&zonePair : m_zones)
+    {
+        zonePair.second.samples.clear();
+        zonePair.second.next = 0;
+    }
+}
+
+void TimestampProfiler::readResults(const PendingZone &pendingZone, bool executed)
+{
+    lock_guard<mutex> locker(m_mutex);
+
+    m_freeQueries.push_back(pendingZone.query);
+
+    if (!executed)
+        return;
+
+    uint64_t timestamps[2] = {};
+    const auto result = m_device->getQueryPoolResults(
+        *m_queryPool,
+        pendingZone.query,
+        2,
+        sizeof(timestamps),
+        timestamps,
+        sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64,
+        m_device->dld()
+    );
+    if (result != vk::Result::eSuccess)
+        return;
+
+    const uint64_t ticks = (timestamps[1] - timestamps[0]) & pendingZone.timestampMask;
+    const double sample = ticks * m_timestampPeriod / 1e6;
+
+    auto &zoneSamples = *pendingZone.zoneSamples;
+    if (zoneSamples.samples.size() < m_historySize)
+    {
+        zoneSamples.samples.push_back(sample);
+    }
+    else
+    {
+        zoneSamples.samples[zoneSamples.next] = sample;
+        zoneSamples.next = (zoneSamples.next + 1) % m_historySize;
+    }
+}
+
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <map>
+
+namespace QmVk {
+
+using namespace std;
+
+class CommandBuffer;
+class Device;
+
+// Measures GPU time of named zones with timestamp queries. Zones must begin outside
+// of a render pass, because their queries are reset in the command buffer. Results are
+// read when the submission is finished (see "CommandBuffer::addRecordingCallback()"),
+// queries of discarded recordings are freed. Zones are skipped if the queue family
+// doesn't support timestamps or all queries are in use. The profiler must outlive
+// the command buffers which use it.
+class QMVK_EXPORT TimestampProfiler : public enable_shared_from_this<TimestampProfiler>
+{
+    struct ZoneSamples
+    {
+        vector<double> samples;
+        size_t next = 0;
+    };
+
+    struct PendingZone
+    {
+        ZoneSamples *zoneSamples;
+        uint32_t query;
+        uint64_t timestampMask;
+    };
+
+public:
+    // Times are in milliseconds, computed from the last samples of the zone
+    struct Statistics
+    {
+        size_t samples = 0;
+        double min = 0.0;
+        double avg = 0.0;
+        double p99 = 0.0;
+    };
+
+    class QMVK_EXPORT Zone
+    {
+        friend class TimestampProfiler;
+
+    public:
+        Zone() = default;
+
+    public:
+        inline bool isValid() const;
+
+    private:
+        ZoneSamples *m_zoneSamples = nullptr;
+        uint32_t m_query = ~0u;
+        uint64_t m_timestampMask = 0;
+    };
+
+    // Zone which ends when it goes out of scope
+    class QMVK_EXPORT Scope
+    {
+        Scope(const Scope &) = delete;
+
+    public:
+        Scope(
+            const shared_ptr<TimestampProfiler> &profiler,
+            const shared_ptr<CommandBuffer> &commandBuffer,
+            const string &name
+        );
+        ~Scope();
+
+    private:
+        const shared_ptr<TimestampProfiler> m_profiler;
+        const shared_ptr<CommandBuffer> m_commandBuffer;
+        const Zone m_zone;
+    };
+
+public:
+    static shared_ptr<TimestampProfiler> create(
+        const shared_ptr<Device> &device,
+        uint32_t maxPendingZones = 256,
+        uint32_t historySize = 256
+    );
+
+public:
+    TimestampProfiler(
+        const shared_ptr<Device> &device,
+        uint32_t maxPendingZones,
+        uint32_t historySize
+    );
+    ~TimestampProfiler();
+
+private:
+    void init();
+
+    void readResults(const PendingZone &pendingZone, bool executed);
+
+public:
+    inline shared_ptr<Device> device() const;
+
+    Zone beginZone(const shared_ptr<CommandBuffer> &commandBuffer, const string &name);
+    void endZone(const shared_ptr<CommandBuffer> &commandBuffer, const Zone &zone);
+
+    map<string, Statistics> statistics();
+    void clearStatistics();
+
+private:
+    const shared_ptr<Device> m_device;
+    const uint32_t m_maxPendingZones;
+    const uint32_t m_historySize;
+
+    double m_timestampPeriod = 1.0;
+
+    vk::UniqueQueryPool m_queryPool;
+
+    mutex m_mutex;
+    map<string, ZoneSamples> m_zones;
+    vector<uint32_t> m_freeQueries;
+};
+
+/* Inline implementation */
+
+bool TimestampProfiler::Zone::isValid() const
+{
+    return (m_zoneSamples != nullptr);
+}
+
+shared_ptr<Device> TimestampProfiler::device() const
+{
+    return m_device;
+}
+
+}
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#include "UploadService.hpp"
+#include "CommandBufferRing.hpp"
+#include "PhysicalDevice.hpp"
+#include "MemoryObject.hpp"
+#include "Device.hpp"
+#include "Queue.hpp"
+
+#include <algorithm>
+
+namespace QmVk {
+
+static constexpr uint32_t g_commandBuffersCount = 3;
+
+shared_ptr<UploadService> UploadService::create(
+    const shared_ptr<Device> &device)
+{
+    auto uploadService = make_shared<UploadService>(
+        device
+    );
+    uploadService->init();
+    return uploadService;
+}
+
+UploadService::UploadService(
+    const shared_ptr<Device> &device)
+    : m_device(device)
+{}
+UploadService::~UploadService()
+{
+    if (m_commandBufferRing)
+        m_commandBufferRing->waitAll();
+}
+
+void UploadService::init()
+{
+    const auto physicalDevice = m_device->physicalDevice();
+    const auto &enabledQueues = m_device->queues();
+
+    const auto queuesFamily = physicalDevice->getQueuesFamily(
+        vk::QueueFlagBits::eTransfer,
+        true,
+        false,
+        false
+    );
+    for (auto &&queueFamily : queuesFamily)
+    {
+        const uint32_t queueFamilyIndex = queueFamily.first;
+        if (find(enabledQueues.begin(), enabledQueues.end(), queueFamilyIndex) == enabledQueues.end())
+            continue;
+
+        const bool transferOnly = !(physicalDevice->getQueueProps(queueFamilyIndex).flags & vk::QueueFlagBits::eCompute);
+        if (m_queue && !transferOnly)
+            continue;
+
+        // Use the last queue, the first one is usually used for rendering
+        m_queue = m_device->queue(queueFamilyIndex, m_device->numQueues(queueFamilyIndex) - 1);
+        if (transferOnly)
+            break;
+    }
+    if (!m_queue)
+        m_queue = m_device->firstQueue();
+
+    m_commandBufferRing = CommandBufferRing::create(m_queue, g_commandBuffersCount);
+
+    if (m_device->hasTimelineSemaphore())
+        m_timelineSemaphore = TimelineSemaphore::create(m_device);
+}
+
+uint32_t UploadService::queueFamilyIndex() const
+{
+    return m_queue->queueFamilyIndex();
+}
+
+UploadService::Upload UploadService::upload(
+    const CommandBuffer::CommandCallback &callback,
+    const vector<shared_ptr<MemoryObject>> &objects,
+    uint32_t dstQueueFamilyIndex)
+{
+    lock_guard<mutex> locker(m_mutex);
+
+    auto commandBuffer = m_commandBufferRing->beginNext();
+    try
+    {
+        callback(*commandBuffer);
+    }
+    catch (...)
+    {
+        commandBuffer->abortRecording();
+        throw;
+    }
+
+    for (auto &&object : objects)
+    {
+        if (dstQueueFamilyIndex != VK_QUEUE_FAMILY_IGNORED)
+            object->releaseOwnership(*commandBuffer, queueFamilyIndex(), dstQueueFamilyIndex);
+        commandBuffer->storeData(object);
+    }
+
+    Upload upload;
+    if (m_timelineSemaphore)
+    {
+        upload.waitPoint.semaphore = m_timelineSemaphore;
+        upload.waitPoint.value = ++m_timelineValue;
+        upload.completion = commandBuffer->endSubmit({}, {upload.waitPoint});
+    }
+    else
+    {
+        upload.completion = m_commandBufferRing->submit();
+    }
+    return upload;
+}
+
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+#pragma once
+
+#include "QmVkExport.hpp"
+
+#include "TimelineSemaphore.hpp"
+#include "CommandBuffer.hpp"
+
+#include <mutex>
+
+namespace QmVk {
+
+using namespace std;
+
+class Device;
+class Queue;
+class MemoryObject;
+class CommandBufferRing;
+
+// Records copies on a separate transfer queue (preferably transfer-only family),
+// so they can run while the graphics/compute queue is busy.
+class QMVK_EXPORT UploadService
+{
+public:
+    struct Upload
+    {
+        Completion completion;
+        TimelineSemaphore::Point waitPoint; // Empty if timeline semaphores are not enabled
+    };
+
+public:
+    static shared_ptr<UploadService> create(
+        const shared_ptr<Device> &device
+    );
+
+public:
+    UploadService(
+        const shared_ptr<Device> &device
+    );
+    ~UploadService();
+
+private:
+    void init();
+
+public:
+    inline shared_ptr<Queue> queue() const;
+    uint32_t queueFamilyIndex() const;
+
+    // "callback" records the copies, then ownership of "objects" is released to "dstQueueFamilyIndex".
+    // The destination queue must wait for "waitPoint" (or "completion") before using the objects.
+    Upload upload(
+        const CommandBuffer::CommandCallback &callback,
+        const vector<shared_ptr<MemoryObject>> &objects = {},
+        uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED
+    );
+
+private:
+    const shared_ptr<Device> m_device;
+
+    shared_ptr<Queue> m_queue;
+    shared_ptr<CommandBufferRing> m_commandBufferRing;
+
+    mutex m_mutex;
+    shared_ptr<TimelineSemaphore> m_timelineSemaphore;
+    uint64_t m_timelineValue = 0;
+};
+
+/* Inline implementation */
+
+shared_ptr<Queue> UploadService::queue() const
+{
+    return m_queue;
+}
+
+}
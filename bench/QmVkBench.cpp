@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: MIT
+/*
+   QmVk - simple Vulkan library created for QMPlay2
+   Copyright (C) 2020-2025 Błażej Szczygieł
+*/
+
+// Runs the benchmarks on the first Vulkan device (or the first device which name contains
+// "QMVK_BENCH_DEVICE", e.g. "llvmpipe") and prints one JSON object per line to stdout.
+
+#include <AbstractInstance.hpp>
+#include <PhysicalDevice.hpp>
+#include <Device.hpp>
+#include <Queue.hpp>
+#include <CommandBuffer.hpp>
+#include <Buffer.hpp>
+#ifndef QMVK_NO_GRAPHICS
+#   include <Image.hpp>
+#endif
+#include <ShaderModule.hpp>
+#include <ComputePipeline.hpp>
+#include <MemoryObjectDescrs.hpp>
+#include <MemoryPropertyFlags.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace std;
+using namespace QmVk;
+
+class BenchInstance final : public AbstractInstance
+{
+public:
+    static shared_ptr<BenchInstance> create()
+    {
+        auto instance = make_shared<BenchInstance>();
+        instance->init();
+        return instance;
+    }
+
+public:
+    BenchInstance() = default;
+    ~BenchInstance()
+    {
+        if (*this)
+            destroy(nullptr, dld());
+    }
+
+private:
+    void init()
+    {
+        const auto vkGetInstanceProcAddr = loadVulkanLibrary();
+        initDispatchLoaderDynamic(vkGetInstanceProcAddr);
+
+        vk::ApplicationInfo applicationInfo;
+        applicationInfo.pApplicationName = "qmvk_bench";
+        applicationInfo.apiVersion = isVk10() ? VK_API_VERSION_1_0 : VK_API_VERSION_1_1;
+
+        vk::InstanceCreateInfo instanceCreateInfo;
+        instanceCreateInfo.pApplicationInfo = &applicationInfo;
+        static_cast<vk::Instance &>(*this) = vk::createInstance(instanceCreateInfo, nullptr, dld());
+
+        initDispatchLoaderDynamic(vkGetInstanceProcAddr, *this);
+    }
+
+    bool isCompatibleDevice(const shared_ptr<PhysicalDevice> &physicalDevice) const override
+    {
+        const char *deviceName = getenv("QMVK_BENCH_DEVICE");
+        if (!deviceName || !*deviceName)
+            return true;
+        return (string(physicalDevice->properties().deviceName.data()).find(deviceName) != string::npos);
+    }
+};
+
+template<typename Fn>
+static void bench(const char *name, uint32_t iterations, double bytesPerOp, Fn &&fn)
+{
+    using Clock = chrono::steady_clock;
+
+    fn(); // Warm-up
+
+    const auto t1 = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+        fn();
+    const auto t2 = Clock::now();
+
+    const double ns = chrono::duration<double, nano>(t2 - t1).count();
+    const double nsPerOp = ns / iterations;
+
+    printf("{\"name\":\"%s\",\"iterations\":%u,\"ns_per_op\":%.1f", name, iterations, nsPerOp);
+    if (bytesPerOp > 0.0)
+        printf(",\"mib_per_s\":%.1f", bytesPerOp / (1024.0 * 1024.0) / (nsPerOp / 1e9));
+    printf("}\n");
+    fflush(stdout);
+}
+
+static vector<uint32_t> readShader(const char *fileName)
+{
+    ifstream file(string(QMVK_BENCH_SHADERS_DIR "/") + fileName, ios::binary);
+    const string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (data.empty() || data.size() % sizeof(uint32_t) != 0)
+        throw runtime_error(string("Unable to read shader: ") + fileName);
+
+    vector<uint32_t> spirv(data.size() / sizeof(uint32_t));
+    memcpy(spirv.data(), data.data(), data.size());
+    return spirv;
+}
+
+static void run()
+{
+    constexpr vk::DeviceSize bufferSize = 64 << 20;
+    constexpr uint32_t numElements = 1 << 20;
+
+    const auto instance = BenchInstance::create();
+    const auto physicalDevice = instance->enumeratePhysicalDevices(true).at(0);
+
+#ifndef QMVK_NO_GRAPHICS
+    constexpr auto queueFlags = vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute;
+#else
+    constexpr auto queueFlags = vk::QueueFlagBits::eCompute;
+#endif
+    const auto device = instance->createDevice(
+        physicalDevice,
+        vk::PhysicalDeviceFeatures2(),
+        {},
+        physicalDevice->getQueuesFamily(queueFlags, false, true, true)
+    );
+    const auto commandBuffer = CommandBuffer::create(device->firstQueue());
+
+    printf("{\"device\":\"%s\",\"api_version\":\"%u.%u.%u\"}\n",
+        physicalDevice->properties().deviceName.data(),
+        VK_VERSION_MAJOR(physicalDevice->properties().apiVersion),
+        VK_VERSION_MINOR(physicalDevice->properties().apiVersion),
+        VK_VERSION_PATCH(physicalDevice->properties().apiVersion)
+    );
+
+    const vk::BufferUsageFlags bufferUsage =
+        vk::BufferUsageFlagBits::eTransferSrc |
+        vk::BufferUsageFlagBits::eTransferDst |
+        vk::BufferUsageFlagBits::eStorageBuffer
+    ;
+    const auto srcBuffer = Buffer::create(device, bufferSize, bufferUsage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+    const auto dstBuffer = Buffer::create(device, bufferSize, bufferUsage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    // GPU paths, every operation is submitted and waited for
+
+    bench("buffer_copy_64mib", 20, bufferSize, [&] {
+        commandBuffer->execute([&](vk::CommandBuffer) {
+            srcBuffer->copyTo(dstBuffer, commandBuffer);
+        });
+    });
+    bench("buffer_fill_64mib", 20, bufferSize, [&] {
+        commandBuffer->execute([&](vk::CommandBuffer) {
+            dstBuffer->fill(0x12345678, 0, bufferSize, commandBuffer);
+        });
+    });
+
+#ifndef QMVK_NO_GRAPHICS
+    const vk::Extent2D imageSize(1920, 1080);
+    const auto srcImage = Image::createOptimal(device, imageSize, vk::Format::eR8G8B8A8Unorm, true);
+    const auto dstImage = Image::createOptimal(device, imageSize, vk::Format::eR8G8B8A8Unorm, true);
+
+    bench("image_copy_1080p_rgba8", 50, imageSize.width * imageSize.height * 4.0, [&] {
+        commandBuffer->execute([&](vk::CommandBuffer) {
+            srcImage->copyTo(dstImage, commandBuffer);
+        });
+    });
+    bench("image_mipmaps_1080p_rgba8", 50, 0.0, [&] {
+        commandBuffer->execute([&](vk::CommandBuffer) {
+            dstImage->maybeGenerateMipmaps(commandBuffer);
+        });
+    });
+#endif
+
+    const auto computePipeline = ComputePipeline::create(
+        device,
+        ShaderModule::create(device, vk::ShaderStageFlagBits::eCompute, readShader("bench.comp.spv")),
+        sizeof(uint32_t)
+    );
+    computePipeline->setMemoryObjects({
+        {srcBuffer, MemoryObjectDescr::Access::Storage},
+    });
+    computePipeline->prepare();
+    *computePipeline->pushConstants<uint32_t>() = numElements;
+
+    const auto localSize = computePipeline->localWorkGroupSize();
+    const vk::Extent2D groupCount(
+        (numElements + localSize.width * localSize.height - 1) / (localSize.width * localSize.height),
+        1
+    );
+    bench("compute_dispatch_1m", 100, numElements * sizeof(uint32_t), [&] {
+        commandBuffer->execute([&](vk::CommandBuffer) {
+            computePipeline->recordCommands(commandBuffer, groupCount);
+        });
+    });
+    bench("compute_submit_overhead", 1000, 0.0, [&] {
+        commandBuffer->execute([&](vk::CommandBuffer) {
+            computePipeline->recordCommands(commandBuffer, vk::Extent2D(1, 1));
+        });
+    });
+
+    // CPU paths
+
+    const MemoryObjectDescrs memoryObjectsA {
+        {srcBuffer, MemoryObjectDescr::Access::Storage},
+    };
+    const MemoryObjectDescrs memoryObjectsB {
+        {dstBuffer, MemoryObjectDescr::Access::Storage},
+    };
+    const MemoryObjectDescrs memoryObjectsA2 {
+        {srcBuffer, MemoryObjectDescr::Access::Storage},
+    };
+
+    bool toggle = false;
+    bench("descriptor_update", 10000, 0.0, [&] {
+        computePipeline->setMemoryObjects((toggle = !toggle) ? memoryObjectsB : memoryObjectsA);
+        computePipeline->prepare();
+    });
+    bench("pipeline_prepare", 100000, 0.0, [&] {
+        computePipeline->prepare();
+    });
+
+    volatile bool equal = false;
+    bench("memory_object_descrs_compare", 1000000, 0.0, [&] {
+        equal = (memoryObjectsA == memoryObjectsA2);
+    });
+    (void)equal;
+
+    bench("command_buffer_store_data", 1000000, 0.0, [&] {
+        commandBuffer->storeData(memoryObjectsA, nullptr);
+        commandBuffer->storeData(memoryObjectsB, nullptr);
+        commandBuffer->resetStoredData();
+    });
+
+    volatile uint32_t memoryTypeIdx = 0;
+    bench("physical_device_find_memory_type", 1000000, 0.0, [&] {
+        memoryTypeIdx = physicalDevice->findMemoryType(vk::MemoryPropertyFlagBits::eDeviceLocal).first;
+    });
+    (void)memoryTypeIdx;
+}
+
+int main()
+{
+    try
+    {
+        run();
+    }
+    catch (const exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}